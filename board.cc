@@ -1,7 +1,11 @@
 #include <cmath>
+#include <cstring>
 #include <stdexcept>
 #include <utility>
 
+#include "piece_values.h"
+#include "zobrist.h"
+
 #include "board.h"
 
 Board::Square::Square() : attacksKing{ false, false } {}
@@ -42,11 +46,12 @@ Board::Capture::Capture(Piece piece, Coord location)
 
 Board::Crumb::Crumb(const Move &move, std::unique_ptr<Capture> capture,
     std::unique_ptr<Coord> enPassantTarget,
-    std::array<CastlingRights, 2> castlingRights)
+    std::array<CastlingRights, 2> castlingRights, int halfmoveClock)
   : move{ move }
   , capture{ std::move(capture) }
   , enPassantTarget{ std::move(enPassantTarget) }
   , castlingRights{ castlingRights }
+  , halfmoveClock{ halfmoveClock }
 {}
 
 Board::Crumb::Crumb(const Crumb &other)
@@ -54,6 +59,7 @@ Board::Crumb::Crumb(const Crumb &other)
   , capture{ other.capture ? std::make_unique<Capture>(*other.capture) : nullptr }
   , enPassantTarget{ other.enPassantTarget ? std::make_unique<Coord>(*other.enPassantTarget) : nullptr }
   , castlingRights{ other.castlingRights }
+  , halfmoveClock{ other.halfmoveClock }
 {}
 
 Board::Crumb::Crumb(Crumb &&other) = default;
@@ -199,7 +205,6 @@ void Board::update(Coord coord) {
       } break;
       case BISHOP: {
         tryAddDiag(coord);
-        tryAddDiag(coord);
       } break;
       case QUEEN: {
         tryAddHoriVert(coord);
@@ -282,6 +287,12 @@ std::vector<Coord> Board::quickMove(const Move &move) {
   // promotion
   if (move.promoteTo != PAWN) dest.piece->type = move.promoteTo;
 
+  // save old hash before updating it
+  keys.push_back(hash);
+  hash ^= zobristPiece(piece, from) ^ zobristPiece(*dest.piece, to);
+  removeScore(piece, from);
+  addScore(*dest.piece, to);
+
   // save old en passant target before overwriting it
   std::unique_ptr<Coord> oldEnPassantTarget = std::move(enPassantTarget);
 
@@ -307,7 +318,17 @@ std::vector<Coord> Board::quickMove(const Move &move) {
       rookCastling = std::make_unique<Move>(Coord(to.row, 7), Coord(to.row, 5));
     }
     squareAt(rookCastling->to).piece = std::move(squareAt(rookCastling->from).piece);
+    Piece rook = *squareAt(rookCastling->to).piece;
+    hash ^= zobristPiece(rook, rookCastling->from) ^ zobristPiece(rook, rookCastling->to);
+    removeScore(rook, rookCastling->from);
+    addScore(rook, rookCastling->to);
+  }
+  if (capture) {
+    hash ^= zobristPiece(capture->piece, capture->location);
+    removeScore(capture->piece, capture->location);
   }
+  if (oldEnPassantTarget) hash ^= zobristEnPassant(oldEnPassantTarget->col);
+  if (enPassantTarget) hash ^= zobristEnPassant(enPassantTarget->col);
 
   // save old castling rights before we modify it
   std::array<CastlingRights, 2> oldCastlingRights = castlingRights;
@@ -317,6 +338,19 @@ std::vector<Coord> Board::quickMove(const Move &move) {
     if (from.col == 4 || from.col == 0) castlingRights[turn].queenSide = false;
     if (from.col == 4 || from.col == 7) castlingRights[turn].kingSide = false;
   }
+  // a rook captured on its initial square can't castle anymore
+  if (capture && capture->location.row == (turn == WHITE ? 7 : 0)) {
+    if (capture->location.col == 0) castlingRights[!turn].queenSide = false;
+    if (capture->location.col == 7) castlingRights[!turn].kingSide = false;
+  }
+  for (int colour = BLACK; colour <= WHITE; ++colour) {
+    if (castlingRights[colour].queenSide != oldCastlingRights[colour].queenSide) {
+      hash ^= zobristCastling(static_cast<Colour>(colour), false);
+    }
+    if (castlingRights[colour].kingSide != oldCastlingRights[colour].kingSide) {
+      hash ^= zobristCastling(static_cast<Colour>(colour), true);
+    }
+  }
 
   // update pawns next to old en passant target
   // NOTE: this depends on turn so we have to do this before updating turn
@@ -339,10 +373,17 @@ std::vector<Coord> Board::quickMove(const Move &move) {
 
   // push crumb onto history
   history.emplace_back(move, std::move(capture), std::move(oldEnPassantTarget),
-    oldCastlingRights);
+    oldCastlingRights, halfmoveClock);
+
+  if (piece.type == PAWN || history.back().capture) {
+    halfmoveClock = 0;
+  } else {
+    ++halfmoveClock;
+  }
   
   // update turn
   turn = !turn;
+  hash ^= zobristTurn();
 
   return changed;
 }
@@ -354,16 +395,20 @@ std::vector<Coord> Board::quickUndo() {
   Coord from = move.from, to = move.to;
   Square &origin = squareAt(from), &dest = squareAt(to);
 
+  removeScore(*dest.piece, to);
+
   // undo promotion
   if (move.promoteTo != PAWN) dest.piece->type = PAWN;
 
   // move piece back
   origin.piece = std::move(dest.piece);
+  addScore(*origin.piece, from);
 
   // restore captured piece
   if (crumb.capture) {
     Square &location = squareAt(crumb.capture->location);
     location.piece = std::make_unique<Piece>(crumb.capture->piece);
+    addScore(crumb.capture->piece, crumb.capture->location);
   }
 
   // undo castling (move of rook)
@@ -375,6 +420,9 @@ std::vector<Coord> Board::quickUndo() {
       rookCastling = std::make_unique<Move>(Coord(to.row, 7), Coord(to.row, 5));
     }
     squareAt(rookCastling->from).piece = std::move(squareAt(rookCastling->to).piece);
+    Piece rook = *squareAt(rookCastling->from).piece;
+    removeScore(rook, rookCastling->to);
+    addScore(rook, rookCastling->from);
   }
 
   // move en passant target out before we overwrite it
@@ -386,6 +434,9 @@ std::vector<Coord> Board::quickUndo() {
   // restore en passant target and castling rights
   enPassantTarget = std::move(crumb.enPassantTarget);
   castlingRights = crumb.castlingRights;
+  halfmoveClock = crumb.halfmoveClock;
+  hash = keys.back();
+  keys.pop_back();
 
   // update new en passant pawns so they lose en passant move
   // NOTE: must do this before flipping turn since tryUpdateEnPassantPawn
@@ -411,8 +462,8 @@ std::vector<Coord> Board::quickUndo() {
   }
 
   // if castling rights different update king
-  if (castlingRights[BLACK] != newCastlingRights[BLACK]) update(Coord(0, 4));
-  if (castlingRights[WHITE] != newCastlingRights[WHITE]) update(Coord(7, 4));
+  if (castlingRights[BLACK] != newCastlingRights[BLACK]) update(Coord(7, 4));
+  if (castlingRights[WHITE] != newCastlingRights[WHITE]) update(Coord(0, 4));
 
   // NOTE: must do this at the end since crumb is a reference to history.back()
   history.pop_back();
@@ -425,6 +476,89 @@ bool Board::hasPiece(Square &square, Piece piece) const {
   return square.piece->colour == piece.colour && square.piece->type == piece.type;
 }
 
+uint64_t Board::computeHash() const {
+  uint64_t result = 0;
+  for (int row = 0; row < 8; ++row) {
+    for (int col = 0; col < 8; ++col) {
+      const Piece *piece = squares[row][col].piece.get();
+      if (piece) result ^= zobristPiece(*piece, Coord(row, col));
+    }
+  }
+  for (int colour = BLACK; colour <= WHITE; ++colour) {
+    if (castlingRights[colour].queenSide) {
+      result ^= zobristCastling(static_cast<Colour>(colour), false);
+    }
+    if (castlingRights[colour].kingSide) {
+      result ^= zobristCastling(static_cast<Colour>(colour), true);
+    }
+  }
+  if (enPassantTarget) result ^= zobristEnPassant(enPassantTarget->col);
+  if (turn == BLACK) result ^= zobristTurn();
+  return result;
+}
+
+void Board::addScore(Piece piece, Coord coord) {
+  material[piece.colour] += pieceValue(piece.type);
+  if (piece.type != PAWN) nonPawnMaterial[piece.colour] += pieceValue(piece.type);
+  pieceSquare[MIDDLEGAME][piece.colour] += pieceSquareValue(piece, coord, MIDDLEGAME);
+  pieceSquare[ENDGAME][piece.colour] += pieceSquareValue(piece, coord, ENDGAME);
+  phase += phaseWeight(piece.type);
+  if (piece.type == PAWN) pawnHash ^= zobristPiece(piece, coord);
+}
+
+void Board::removeScore(Piece piece, Coord coord) {
+  material[piece.colour] -= pieceValue(piece.type);
+  if (piece.type != PAWN) nonPawnMaterial[piece.colour] -= pieceValue(piece.type);
+  pieceSquare[MIDDLEGAME][piece.colour] -= pieceSquareValue(piece, coord, MIDDLEGAME);
+  pieceSquare[ENDGAME][piece.colour] -= pieceSquareValue(piece, coord, ENDGAME);
+  phase -= phaseWeight(piece.type);
+  if (piece.type == PAWN) pawnHash ^= zobristPiece(piece, coord);
+}
+
+void Board::computeScores() {
+  material = { 0, 0 };
+  nonPawnMaterial = { 0, 0 };
+  pieceSquare = {{ { 0, 0 }, { 0, 0 } }};
+  phase = 0;
+  pawnHash = 0;
+  for (int row = 0; row < 8; ++row) {
+    for (int col = 0; col < 8; ++col) {
+      const Piece *piece = squares[row][col].piece.get();
+      if (piece) addScore(*piece, Coord(row, col));
+    }
+  }
+}
+
+void Board::pushAccumulator() {
+  if (!network) return;
+  const Crumb &crumb = history.back();
+  const Move &move = crumb.move;
+  Piece piece = *squareAt(move.to).piece;
+  accumulators.push_back(accumulators.back());
+  Accumulator &accumulator = accumulators.back();
+  network->removePiece(accumulator, move.promoteTo != PAWN ? Piece(piece.colour, PAWN) : piece, move.from);
+  network->addPiece(accumulator, piece, move.to);
+  if (crumb.capture) network->removePiece(accumulator, crumb.capture->piece, crumb.capture->location);
+  if (piece.type == KING && std::abs(move.to.col - move.from.col) == 2) {
+    // castling, the rook moved too
+    Piece rook(piece.colour, ROOK);
+    int row = move.to.row;
+    bool kingSide = move.to.col == 6;
+    network->removePiece(accumulator, rook, Coord(row, kingSide ? 7 : 0));
+    network->addPiece(accumulator, rook, Coord(row, kingSide ? 5 : 3));
+  }
+}
+
+void Board::popAccumulator() {
+  if (!network) return;
+  if (accumulators.size() > 1) {
+    accumulators.pop_back();
+  } else {
+    // the move was made before the board was copied
+    network->refresh(*this, accumulators.back());
+  }
+}
+
 void Board::tryRetractCastlingRights(Colour colour) {
   int row = colour == WHITE ? 0 : 7;
   if (!hasPiece(squares[row][4], Piece(colour, KING))
@@ -496,9 +630,24 @@ void Board::updateState() {
       state = STALEMATE;
     };
   }
+  // checkmate takes precedence over the draw rules
+  if (state == NORMAL || state == CHECK) {
+    if (halfmoveClock >= 100) {
+      state = FIFTY_MOVES;
+    } else if (repeated(2)) {
+      state = REPETITION;
+    }
+    // the game is over
+    if (state != NORMAL && state != CHECK) moves.clear();
+  }
 }
 
-Board::Board() : state{ NORMAL } , turn{ WHITE } , kingAttackers{ 0, 0 } {
+Board::Board()
+  : state{ NORMAL }
+  , turn{ WHITE }
+  , kingAttackers{ 0, 0 }
+  , halfmoveClock{ 0 }
+{
   for (int col = 0; col < 8; ++col) {
     squares[1][col].piece = std::make_unique<Piece>(WHITE, PAWN);
     squares[6][col].piece = std::make_unique<Piece>(BLACK, PAWN);
@@ -528,6 +677,9 @@ Board::Board() : state{ NORMAL } , turn{ WHITE } , kingAttackers{ 0, 0 } {
     update(Coord(7, col));
   }
 
+  hash = computeHash();
+  computeScores();
+
   updateMoves();
 }
 
@@ -538,9 +690,22 @@ Board::Board(const Board &other)
   , kingAttackers{ other.kingAttackers }
   , enPassantTarget{ other.enPassantTarget ? std::make_unique<Coord>(*other.enPassantTarget) : nullptr }
   , castlingRights{ other.castlingRights }
+  , hash{ other.hash }
+  , keys{ other.keys }
+  , halfmoveClock{ other.halfmoveClock }
+  , material{ other.material }
+  , nonPawnMaterial{ other.nonPawnMaterial }
+  , pieceSquare{ other.pieceSquare }
+  , phase{ other.phase }
+  , pawnHash{ other.pawnHash }
+  , network{ other.network }
+  // only the current accumulator, undoing further back refreshes it
+  , accumulators(other.accumulators.empty() ? 0 : 1)
   , moves{ other.moves }
   , history{ other.history }
-{}
+{
+  if (!accumulators.empty()) accumulators.back() = other.accumulators.back();
+}
 
 Board::Board(Board &&other) = default;
 
@@ -556,6 +721,7 @@ Board &Board::operator=(Board &&other) = default;
 Board::Board(const std::array<std::array<std::unique_ptr<Piece>, 8>, 8> &pieces, Colour turn)
   : turn{ turn }
   , kingAttackers{ 0, 0 }
+  , halfmoveClock{ 0 }
 {
   for (int row = 0; row < 8; ++row) {
     for (int col = 0; col < 8; ++col) {
@@ -570,6 +736,9 @@ Board::Board(const std::array<std::array<std::unique_ptr<Piece>, 8>, 8> &pieces,
   tryRetractCastlingRights(WHITE);
   tryRetractCastlingRights(BLACK);
 
+  hash = computeHash();
+  computeScores();
+
   // update each square with a piece
   for (int row = 0; row < 8; ++row) {
     for (int col = 0; col < 8; ++col) {
@@ -593,15 +762,80 @@ std::vector<Move> Board::legalMoves() const {
   return std::vector<Move>(moves.begin(), moves.end());
 }
 
+bool Board::isCapture(const Move &move) const {
+  if (move.promoteTo != PAWN || squares[move.to.row][move.to.col].piece) return true;
+  // en passant, a pawn moving diagonally to an empty square
+  const Piece *piece = squares[move.from.row][move.from.col].piece.get();
+  return piece && piece->type == PAWN && move.from.col != move.to.col;
+}
+
+std::vector<Move> Board::legalCaptures() const {
+  std::vector<Move> result;
+  for (const Move &move : moves) {
+    if (isCapture(move)) result.push_back(move);
+  }
+  return result;
+}
+
+std::vector<Move> Board::legalQuietMoves() const {
+  std::vector<Move> result;
+  for (const Move &move : moves) {
+    if (!isCapture(move)) result.push_back(move);
+  }
+  return result;
+}
+
+bool Board::hasLegalMoves() const {
+  return !moves.empty();
+}
+
+const Move *Board::lastMove() const {
+  return history.empty() ? nullptr : &history.back().move;
+}
+
 bool Board::isLegalMove(const Move &move) const {
   return moves.count(move);
 }
 
+bool Board::givesCheck(const Move &move) {
+  quickMove(move);
+  // turn is flipped, the opponent is to move
+  bool check = kingAttackers[turn];
+  quickUndo();
+  return check;
+}
+
 const Piece *Board::at(int row, int col) const {
   if (outOfBounds(Coord(row, col))) throw std::out_of_range("Coordinates out of range.");
   return squares[row][col].piece.get();
 }
 
+std::vector<Coord> Board::attackers(Coord coord, Colour colour) const {
+  // every piece attacking a square observes it, but pawns also observe the
+  // squares in front of them and beside them (en passant) and kings observe
+  // the squares they castle over
+  std::vector<Coord> result;
+  for (Coord observer : squares[coord.row][coord.col].observers) {
+    const Piece *piece = squares[observer.row][observer.col].piece.get();
+    if (!piece || piece->colour != colour) continue;
+    int rowDistance = coord.row - observer.row;
+    int colDistance = std::abs(coord.col - observer.col);
+    if (piece->type == PAWN
+        && (rowDistance != (colour == WHITE ? 1 : -1) || colDistance != 1)) {
+      continue;
+    }
+    if (piece->type == KING && (std::abs(rowDistance) > 1 || colDistance > 1)) {
+      continue;
+    }
+    result.push_back(observer);
+  }
+  return result;
+}
+
+const std::vector<Coord> &Board::destinations(Coord coord) const {
+  return squares[coord.row][coord.col].moves;
+}
+
 bool Board::hasPriorMove() const {
   return history.size() >= 2;
 }
@@ -610,6 +844,7 @@ void Board::move(const Move &move) {
   if (!isLegalMove(move)) throw std::logic_error("Illegal move.");
   // NOTE: if game is over then moves should be empty so the above covers it
   changedCoords = quickMove(move);
+  pushAccumulator();
   updateMoves();
   updateState();
 }
@@ -619,13 +854,44 @@ Board::State Board::getState() const {
 }
 
 bool Board::gameOver() const {
-  return state == CHECKMATE || state == STALEMATE || state == RESIGNED;
+  return state == CHECKMATE || state == STALEMATE || state == RESIGNED
+    || state == REPETITION || state == FIFTY_MOVES;
 }
 
 Colour Board::getTurn() const {
   return turn;
 }
 
+uint64_t Board::getHash() const {
+  return hash;
+}
+
+int Board::getHalfmoveClock() const {
+  return halfmoveClock;
+}
+
+bool Board::hasCastlingRights(Colour colour, bool kingSide) const {
+  return kingSide ? castlingRights[colour].kingSide : castlingRights[colour].queenSide;
+}
+
+const Coord *Board::getEnPassantTarget() const {
+  return enPassantTarget.get();
+}
+
+bool Board::repeated(int times) const {
+  // the same player must be to move, and it takes at least 4 moves to get
+  // back to a position
+  int size = keys.size();
+  for (int back = 4; back <= halfmoveClock && back <= size; back += 2) {
+    if (keys[size - back] == hash && --times == 0) return true;
+  }
+  return false;
+}
+
+bool Board::isRepetition() const {
+  return repeated(1);
+}
+
 const std::vector<Coord> &Board::getChangedCoords() const {
   return changedCoords;
 }
@@ -636,8 +902,10 @@ void Board::undo() {
     // if previous action was resign, then we simply flip turn and updateMoves
     // and updateState will take care of the rest
     turn = !turn;
+    hash ^= zobristTurn();
   } else {
     changedCoords = quickUndo();
+    popAccumulator();
   }
   updateMoves();
   updateState();
@@ -647,20 +915,116 @@ void Board::atomicUndo() {
   if (!hasPriorMove()) throw std::logic_error("No prior move to undo.");
   if (state == RESIGNED) {
     turn = !turn;
+    hash ^= zobristTurn();
   } else {
     changedCoords = quickUndo();
+    popAccumulator();
   }
   std::vector<Coord> changed = quickUndo();
+  popAccumulator();
   changedCoords.insert(changedCoords.end(), changed.begin(), changed.end());
   updateMoves();
   updateState();
 }
 
+void Board::nullMove() {
+  if (kingAttackers[turn]) throw std::logic_error("Cannot pass while in check.");
+  // from == to marks a null move
+  history.emplace_back(Move(Coord(0, 0), Coord(0, 0)), nullptr,
+    std::move(enPassantTarget), castlingRights, halfmoveClock);
+  keys.push_back(hash);
+  // positions before a pass don't count as repetitions of positions after it
+  halfmoveClock = 0;
+  const Crumb &crumb = history.back();
+  if (crumb.enPassantTarget) {
+    hash ^= zobristEnPassant(crumb.enPassantTarget->col);
+    // pawns next to the old en passant target lose their en passant move
+    // NOTE: this depends on turn so we have to do this before updating turn
+    notifyEnPassantTarget(*crumb.enPassantTarget);
+  }
+  turn = !turn;
+  hash ^= zobristTurn();
+  changedCoords.clear();
+  updateMoves();
+  updateState();
+}
+
+void Board::undoNullMove() {
+  if (history.empty() || history.back().move.from != history.back().move.to) {
+    throw std::logic_error("No null move to undo.");
+  }
+  Crumb &crumb = history.back();
+  enPassantTarget = std::move(crumb.enPassantTarget);
+  halfmoveClock = crumb.halfmoveClock;
+  hash = keys.back();
+  keys.pop_back();
+  turn = !turn;
+  // pawns next to the en passant target regain their en passant move
+  if (enPassantTarget) notifyEnPassantTarget(*enPassantTarget);
+  history.pop_back();
+  changedCoords.clear();
+  updateMoves();
+  updateState();
+}
+
+int Board::getMaterial(Colour colour) const {
+  return material[colour];
+}
+
+int Board::getPieceSquare(Colour colour, GamePhase phase) const {
+  return pieceSquare[phase][colour];
+}
+
+int Board::getPhase() const {
+  return phase;
+}
+
+uint64_t Board::getPawnHash() const {
+  return pawnHash;
+}
+
+bool Board::isConsistent() const {
+  Board scratch = *this;
+  scratch.computeScores();
+  if (network) {
+    Accumulator refreshed;
+    network->refresh(*this, refreshed);
+    if (std::memcmp(&refreshed, &accumulators.back(), sizeof(Accumulator))) return false;
+  }
+  return hash == computeHash() && material == scratch.material
+    && nonPawnMaterial == scratch.nonPawnMaterial
+    && pieceSquare == scratch.pieceSquare && phase == scratch.phase
+    && pawnHash == scratch.pawnHash;
+}
+
+void Board::setNetwork(std::shared_ptr<const Network> network) {
+  this->network = std::move(network);
+  accumulators.clear();
+  if (!this->network) return;
+  accumulators.emplace_back();
+  this->network->refresh(*this, accumulators.back());
+}
+
+const Network *Board::getNetwork() const {
+  return network.get();
+}
+
+const Accumulator *Board::getAccumulator() const {
+  return accumulators.empty() ? nullptr : &accumulators.back();
+}
+
+bool Board::hasNonPawnMaterial(Colour colour) const {
+  // the king is worth 0
+  return nonPawnMaterial[colour] > 0;
+}
+
 void Board::resign() {
   if (gameOver()) throw std::logic_error("Game already over.");
   turn = !turn;
+  hash ^= zobristTurn();
   state = RESIGNED;
   moves.clear();
   // this is not strictly necessary but makes sense
+  if (enPassantTarget) hash ^= zobristEnPassant(enPassantTarget->col);
   enPassantTarget.reset();
 }
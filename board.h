@@ -2,13 +2,16 @@
 #define BOARD_H
 
 #include <array>
+#include <cstdint>
 #include <memory>
 #include <set>
 #include <vector>
 
 #include "colour.h"
 #include "move.h"
+#include "nnue.h"
 #include "piece.h"
+#include "piece_values.h"
 
 class Board {
   struct Square {
@@ -39,9 +42,11 @@ class Board {
     std::unique_ptr<Capture> capture;
     std::unique_ptr<Coord> enPassantTarget;
     std::array<CastlingRights, 2> castlingRights;
+    // halfmove clock before the move
+    int halfmoveClock;
     Crumb(const Move &move, std::unique_ptr<Capture> capture,
       std::unique_ptr<Coord> enPassantTarget,
-      std::array<CastlingRights, 2> castlingRights);
+      std::array<CastlingRights, 2> castlingRights, int halfmoveClock);
     Crumb(const Crumb &);
     Crumb(Crumb &&);
     Crumb &operator=(const Crumb &);
@@ -54,6 +59,10 @@ public:
     CHECKMATE,
     STALEMATE,
     RESIGNED,
+    // draw by the same position occurring three times
+    REPETITION,
+    // draw by fifty moves by each player without a capture or a pawn move
+    FIFTY_MOVES,
   };
 private:
   std::array<std::array<Square, 8>, 8> squares;
@@ -62,6 +71,29 @@ private:
   std::array<int, 2> kingAttackers;
   std::unique_ptr<Coord> enPassantTarget;
   std::array<CastlingRights, 2> castlingRights;
+  // zobrist hash of the position, see zobrist.h
+  uint64_t hash;
+  // hashes of the positions before each move in history, kept apart from the
+  // crumbs so repetition scans read a compact array
+  std::vector<uint64_t> keys;
+  // number of moves (by either player) since the last capture or pawn move
+  int halfmoveClock;
+  // running totals of pieceValue (of all pieces, and of the pieces other
+  // than pawns and kings), pieceSquareValue (indexed by phase, then colour)
+  // and phaseWeight (see piece_values.h) of the pieces, and the zobrist hash
+  // of the pawns alone, kept up to date by quickMove and quickUndo
+  std::array<int, 2> material;
+  std::array<int, 2> nonPawnMaterial;
+  std::array<std::array<int, 2>, 2> pieceSquare;
+  int phase;
+  uint64_t pawnHash;
+  // null unless setNetwork was called
+  std::shared_ptr<const Network> network;
+  // with a network, the accumulator of the position after each move made
+  // since the board was copied (or the network set), the current one last
+  // move pushes and undo pops, so the legality checks of quickMove and
+  // quickUndo never touch them
+  std::vector<Accumulator> accumulators;
   std::set<Move> moves;
   std::vector<Crumb> history;
   std::vector<Coord> changedCoords;
@@ -98,6 +130,19 @@ private:
   // returns changed coords
   std::vector<Coord> quickUndo();
   bool hasPiece(Square &square, Piece piece) const;
+  // whether the position occurred at least times times before
+  bool repeated(int times) const;
+  // hashes the position from scratch
+  uint64_t computeHash() const;
+  // add or remove a piece's value from the running totals
+  void addScore(Piece piece, Coord coord);
+  void removeScore(Piece piece, Coord coord);
+  // computes the running totals from scratch
+  void computeScores();
+  // with a network, pushes the accumulator of the position after the last
+  // move, or pops it after the move was undone
+  void pushAccumulator();
+  void popAccumulator();
   void tryRetractCastlingRights(Colour colour);
   void updateMoves();
   void updateState();
@@ -111,10 +156,58 @@ public:
   Board &operator=(const Board &);
   Board &operator=(Board &&);
   std::vector<Move> legalMoves() const;
+  // true for captures (including en passant) and promotions
+  // assumes move is pseudo-legal
+  bool isCapture(const Move &move) const;
+  // the legal captures (en passant included) and promotions, and the other
+  // legal moves, each a subset of legalMoves() in the same order
+  std::vector<Move> legalCaptures() const;
+  std::vector<Move> legalQuietMoves() const;
+  bool hasLegalMoves() const;
   bool isLegalMove(const Move &move) const;
+  // whether move puts the opponent in check, much cheaper than making it
+  // since the legal moves aren't updated
+  // assumes move is legal
+  bool givesCheck(const Move &move);
   State getState() const;
   bool gameOver() const;
   Colour getTurn() const;
+  // equal positions (pieces, turn, castling rights and en passant target)
+  // have equal hashes
+  uint64_t getHash() const;
+  int getHalfmoveClock() const;
+  // whether colour may still castle on that side, though it may not be able
+  // to right now
+  bool hasCastlingRights(Colour colour, bool kingSide) const;
+  // the pawn that just advanced two squares, null if the last move wasn't
+  // such an advance
+  const Coord *getEnPassantTarget() const;
+  // whether the position occurred before, only looking back to the last
+  // capture or pawn move since earlier positions can't recur
+  bool isRepetition() const;
+  // total value in centipawns of colour's pieces, see pieceValue
+  int getMaterial(Colour colour) const;
+  // total bonus in centipawns for where colour's pieces stand in phase, see
+  // pieceSquareValue
+  int getPieceSquare(Colour colour, GamePhase phase) const;
+  // how far from the endgame the position is, see phaseWeight
+  int getPhase() const;
+  // equal pawn structures (the pawns of both colours on the same squares)
+  // have equal hashes, whatever the other pieces
+  uint64_t getPawnHash() const;
+  // whether the hash, the pawn hash, the running totals and the accumulator
+  // equal their computation from scratch, for tests of the incremental
+  // updates
+  bool isConsistent() const;
+  // keeps the first layer of network up to date as pieces move, so it can
+  // evaluate the position cheaply (see Network), or stops if network is null
+  // copies of the board keep the network
+  void setNetwork(std::shared_ptr<const Network> network);
+  // null if there is no network
+  const Network *getNetwork() const;
+  const Accumulator *getAccumulator() const;
+  // the last move made, from == to for a null move, null if none
+  const Move *lastMove() const;
   // returns the coords that were changed in the last move.
   // if there is no previous move, then this is empty.
   const std::vector<Coord> &getChangedCoords() const;
@@ -126,11 +219,28 @@ public:
   // move following that.
   bool hasPriorMove() const;
   const Piece *at(int row, int col) const;
+  // returns the coords of the pieces of the given colour attacking coord,
+  // ignoring whether they are pinned
+  // assumes coord is within bounds
+  std::vector<Coord> attackers(Coord coord, Colour colour) const;
+  // the squares the piece on coord can move to ignoring pins and checks,
+  // captures and castling included, empty if there is no piece
+  // kept up to date by every move, so reading it costs nothing extra
+  // assumes coord is within bounds
+  const std::vector<Coord> &destinations(Coord coord) const;
   void move(const Move &move);
   // NOTE: can also undo a resign
   void undo();
   // undoes twice in a single transaction
   void atomicUndo();
+  // passes the turn to the other player without moving, for null move
+  // pruning in engine searches
+  // must be undone by undoNullMove, not undo
+  // assumes the player whose turn it is is not in check
+  void nullMove();
+  void undoNullMove();
+  // whether colour has a piece other than pawns and its king
+  bool hasNonPawnMaterial(Colour colour) const;
   void resign();
 };
 
@@ -0,0 +1,384 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "board.h"
+#include "evaluator.h"
+#include "mate_solver.h"
+#include "opening_book.h"
+#include "pgn.h"
+#include "polyglot.h"
+#include "search_trace.h"
+
+#include "board_harness.h"
+
+// NOTE: these are static so they do not clash with the operators of the same
+// signature defined by the displays
+
+static std::ostream &operator<<(std::ostream &out, const Coord &coord) {
+  int row = coord.row + 1;
+  char col = 'a' + coord.col;
+  return out << col << row;
+}
+
+static std::ostream &operator<<(std::ostream &out, PieceType type) {
+  switch (type) {
+  case PAWN:
+    out << "P";
+    break;
+  case ROOK:
+    out << "R";
+    break;
+  case KNIGHT:
+    out << "N";
+    break;
+  case BISHOP:
+    out << "B";
+    break;
+  case QUEEN:
+    out << "Q";
+    break;
+  case KING:
+    out << "K";
+    break;
+  }
+  return out;
+}
+
+static std::ostream &operator<<(std::ostream &out, Piece piece) {
+  char c;
+  switch (piece.type) {
+  case PAWN:
+    c = 'P';
+    break;
+  case ROOK:
+    c = 'R';
+    break;
+  case KNIGHT:
+    c = 'N';
+    break;
+  case BISHOP:
+    c = 'B';
+    break;
+  case QUEEN:
+    c = 'Q';
+    break;
+  case KING:
+    c = 'K';
+    break;
+  }
+  if (piece.colour == BLACK) {
+    c += 'a' - 'A';
+  }
+  return out << c;
+}
+
+static std::istream &operator>>(std::istream &in, PieceType &type) {
+  char c;
+  if (!(in >> c)) return in;
+  switch (c) {
+  case 'R':
+    type = ROOK;
+    break;
+  case 'N':
+    type = KNIGHT;
+    break;
+  case 'B':
+    type = BISHOP;
+    break;
+  case 'Q':
+    type = QUEEN;
+    break;
+  default:
+    in.setstate(std::istream::failbit);
+    break;
+  }
+  return in;
+}
+
+static void printMove(std::ostream &out, const Move &move) {
+  out << "move " << move.from << " " << move.to;
+  if (move.promoteTo != PAWN) out << " " << move.promoteTo;
+  out << std::endl;
+}
+
+// a network with weights drawn from seed, in the network file format (see
+// Network), small enough that the accumulator never overflows
+// outputBias replaces the random output bias unless null
+static std::string randomNetwork(unsigned seed, const int32_t *outputBias) {
+  std::mt19937 rng(seed);
+  std::string bytes = "NNUE";
+  auto write = [&bytes](uint32_t value, int size) {
+    for (int i = 0; i < size; ++i) bytes += static_cast<char>(value >> 8 * i);
+  };
+  auto writeRandom = [&rng, &write](int count, int size, int range) {
+    for (int i = 0; i < count; ++i) write(static_cast<int>(rng() % (2 * range + 1)) - range, size);
+  };
+  write(1, 4);
+  write(Accumulator::size, 4);
+  write(Network::l1Size, 4);
+  writeRandom(Network::numFeatures * Accumulator::size, 2, 64);
+  writeRandom(Accumulator::size, 2, 64);
+  writeRandom(Network::l1Size * 2 * Accumulator::size, 1, 127);
+  writeRandom(Network::l1Size, 4, 1 << 12);
+  writeRandom(Network::l1Size, 1, 127);
+  if (outputBias) {
+    write(*outputBias, 4);
+  } else {
+    writeRandom(1, 4, 1 << 12);
+  }
+  return bytes;
+}
+
+// a new empty file for a test to write and read back, removed by the caller
+static std::string makeTempFile() {
+  char path[] = "/tmp/harnXXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) throw std::logic_error("Cannot create a temporary file.");
+  close(fd);
+  return path;
+}
+
+// writes a book holding moves with their weights for board, between entries
+// of the neighbouring keys, then reads it back: the moves and weights found
+// and how often each is picked
+static void testBook(const Board &board, const std::vector<std::pair<Move, int>> &moves,
+    std::ostream &out) {
+  std::string path = makeTempFile();
+  uint64_t key = polyglotKey(board);
+  uint16_t other = moves.empty() ? 0 : OpeningBook::encodeMove(board, moves.front().first);
+  {
+    std::ofstream file(path, std::ios::binary);
+    OpeningBook::writeEntry(file, key - 1, other, 1, 0);
+    for (const std::pair<Move, int> &move : moves) {
+      OpeningBook::writeEntry(file, key, OpeningBook::encodeMove(board, move.first), move.second, 0);
+    }
+    OpeningBook::writeEntry(file, key + 1, other, 1, 0);
+  }
+  OpeningBook book(path);
+  std::remove(path.c_str());
+  std::vector<OpeningBook::Entry> entries = book.lookup(board);
+  std::vector<int> picks(entries.size());
+  std::mt19937_64 rng(1);
+  const int numPicks = 1000;
+  for (int i = 0; i < numPicks; ++i) {
+    std::unique_ptr<Move> move = book.pick(board, rng);
+    if (!move) break;
+    for (size_t j = 0; j < entries.size(); ++j) {
+      if (entries[j].move == *move) ++picks[j];
+    }
+  }
+  out << "book " << book.size() << " entries" << std::endl;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    out << "weight " << entries[i].weight << " picked " << picks[i] << " ";
+    printMove(out, entries[i].move);
+  }
+}
+
+// records made up events into a trace of two threads, capacity events each,
+// the first recording recorded events and the second half as many, writes it
+// and reads it back, then checks that damaged copies of the file are rejected
+static void testTrace(std::size_t capacity, int recorded, std::ostream &out) {
+  SearchTrace trace(2, capacity);
+  for (int thread = 0; thread < 2; ++thread) {
+    for (int i = 0; i < recorded / (thread + 1); ++i) {
+      TraceEvent event{ static_cast<uint8_t>(i % 4), static_cast<uint8_t>(i % 2),
+        static_cast<uint8_t>(i % 7), static_cast<int8_t>(i % 5 - 1), static_cast<uint16_t>(i),
+        static_cast<uint16_t>(i), -i, i, 2 * i };
+      trace.thread(thread).record(event);
+    }
+  }
+  std::string path = makeTempFile();
+  SearchTrace read;
+  bool written = trace.write(path), wasRead = read.read(path);
+  out << "trace written " << written << " read " << wasRead << std::endl;
+  for (int thread = 0; thread < read.numThreads(); ++thread) {
+    std::vector<TraceEvent> expected = trace.thread(thread).held();
+    std::vector<TraceEvent> events = read.thread(thread).held();
+    out << "thread " << thread << " recorded " << read.thread(thread).numRecorded()
+      << " held " << events.size();
+    if (!events.empty()) out << " first " << events.front().count << " last " << events.back().count;
+    out << std::endl;
+    if (events.size() != expected.size()
+        || std::memcmp(events.data(), expected.data(), events.size() * sizeof(TraceEvent)) != 0) {
+      out << "thread " << thread << " events differ" << std::endl;
+    }
+  }
+
+  std::string bytes;
+  {
+    std::ifstream file(path, std::ios::binary);
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    bytes = contents.str();
+  }
+  // the magic, the version, and the last event cut short
+  std::vector<std::pair<std::string, std::string>> damaged{
+    { "bad magic", "X" + bytes.substr(1) },
+    { "bad version", bytes.substr(0, 4) + '\x7f' + bytes.substr(5) },
+    { "truncated", bytes.substr(0, bytes.size() - 1) },
+  };
+  for (const auto &copy : damaged) {
+    {
+      std::ofstream file(path, std::ios::binary);
+      file << copy.second;
+    }
+    // a rejected file leaves the trace as it was
+    bool rejected = !read.read(path) && read.numThreads() == 2;
+    out << copy.first << (rejected ? " rejected" : " accepted") << std::endl;
+  }
+  std::remove(path.c_str());
+}
+
+void runBoardHarness(std::istream &in, std::ostream &out) {
+  Board board;
+  Evaluator evaluator;
+  std::shared_ptr<Network> network;
+  std::string line;
+  while (getline(in, line)) {
+    std::istringstream iss(std::move(line));
+    std::string cmd;
+    iss >> cmd;
+    try {
+      switch (cmd[0]) {
+        case 'p': {
+          for (int row = 7; row >=0; --row) {
+            out << row + 1 << " ";
+            for (int col = 0; col < 8; ++col) {
+              const Piece *piece = board.at(row, col);
+              if (piece) {
+                out << *piece;
+              } else {
+                if ((row + col) % 2) {
+                  out << ' ';
+                } else {
+                  out << '_';
+                }
+              }
+            }
+            out << std::endl;
+          }
+          out << std::endl;
+          out << "  abcdefgh" << std::endl;
+        } break;
+        case 'm': {
+          Coord from(0, 0), to(0, 0);
+          PieceType promoteTo = PAWN;
+          if (iss >> from >> to) {
+            iss >> promoteTo;
+            board.move(Move(from, to, promoteTo));
+          } else {
+            out << "Invalid move command." << std::endl;
+          }
+        } break;
+        case 'l': {
+          for (const Move &move : board.legalMoves()) {
+            printMove(out, move);
+          }
+        } break;
+        case 'a': {
+          std::string san;
+          if (iss >> san) {
+            board.move(parseSan(board, san));
+          } else {
+            out << "Invalid move command." << std::endl;
+          }
+        } break;
+        case 'u': {
+          board.undo();
+        } break;
+        case 's': {
+          int moves;
+          if (!(iss >> moves)) {
+            out << "Invalid solve command." << std::endl;
+            break;
+          }
+          MateSolver solver;
+          switch (solver.solve(board, moves)) {
+          case MateSolver::MATE:
+            out << "mate in <= " << moves << std::endl;
+            for (const Move &move : solver.mateLine()) printMove(out, move);
+            break;
+          case MateSolver::NO_MATE:
+            out << "no mate in <= " << moves << std::endl;
+            break;
+          case MateSolver::UNKNOWN:
+            out << "unknown" << std::endl;
+            break;
+          }
+        } break;
+        case 'e': {
+          int points = evaluator.evaluate(board);
+          out << "points " << points << " phase " << board.getPhase() << std::endl;
+          if (!network || board.gameOver()) break;
+          // the incremental accumulator and every instruction set must
+          // agree with a fresh scalar evaluation
+          Network::Simd simd = network->getSimd();
+          network->setSimd(Network::SCALAR);
+          int expected = network->evaluate(board);
+          for (int level = Network::SCALAR; level <= Network::supportedSimd(); ++level) {
+            network->setSimd(static_cast<Network::Simd>(level));
+            if (network->evaluate(board) != expected || points != expected) {
+              out << "network mismatch at simd level " << level << std::endl;
+            }
+          }
+          network->setSimd(simd);
+        } break;
+        case 'n': {
+          unsigned seed;
+          if (!(iss >> seed)) {
+            out << "Invalid network command." << std::endl;
+            break;
+          }
+          int32_t outputBias;
+          bool hasOutputBias = static_cast<bool>(iss >> outputBias);
+          std::istringstream file(randomNetwork(seed, hasOutputBias ? &outputBias : nullptr));
+          network = Network::load(file);
+          board.setNetwork(network);
+          evaluator = Evaluator(network);
+          out << "network " << seed << std::endl;
+        } break;
+        case 'k': {
+          std::ostringstream key;
+          key << std::hex << std::setw(16) << std::setfill('0') << polyglotKey(board);
+          out << "key " << key.str() << std::endl;
+        } break;
+        case 'b': {
+          std::vector<std::pair<Move, int>> moves;
+          std::string san;
+          int weight;
+          while (iss >> san >> weight) moves.emplace_back(parseSan(board, san), weight);
+          testBook(board, moves, out);
+        } break;
+        case 't': {
+          std::size_t capacity;
+          int recorded;
+          if (!(iss >> capacity >> recorded)) {
+            out << "Invalid trace command." << std::endl;
+            break;
+          }
+          testTrace(capacity, recorded, out);
+        } break;
+      }
+#ifndef NDEBUG
+      // every script doubles as a test of the incremental updates of the
+      // board, by moves and undos alike
+      if (!board.isConsistent()) out << "inconsistent incremental state" << std::endl;
+#endif
+    } catch (std::logic_error &e) {
+      out << e.what() << std::endl;
+    }
+  }
+}
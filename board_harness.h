@@ -0,0 +1,23 @@
+#ifndef BOARD_HARNESS_H
+#define BOARD_HARNESS_H
+
+#include <iostream>
+
+// runs the board test harness on in, writing to out
+// commands: m(ove) <from> <to> [promotion], a(lgebraic move) <san> (see
+// parseSan), u(ndo), p(rint), l(egal moves),
+// s(olve) <moves> (whether the player to move mates in at most moves, and how),
+// e(valuate) (points for the player to move, see Evaluator, and the phase),
+// n(etwork) <seed> [output bias] (evaluate with a network of random weights
+// from then on, checking it against a fresh scalar evaluation),
+// k(ey) (the Polyglot key, see polyglotKey),
+// b(ook) [<san> <weight>...] (writes a book of these moves and reads it back,
+// see OpeningBook),
+// t(race) <capacity> <events> (writes a trace of made up events and reads it
+// back, see SearchTrace)
+// illegal moves and undos are reported rather than thrown
+// unless NDEBUG is defined, a board whose incremental state (see
+// Board::isConsistent) has gone wrong is reported after every command
+void runBoardHarness(std::istream &in, std::ostream &out);
+
+#endif
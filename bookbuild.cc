@@ -0,0 +1,389 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "board.h"
+#include "opening_book.h"
+#include "pgn.h"
+#include "polyglot.h"
+
+// builds an opening book (see OpeningBook) from games in PGN
+//
+// usage: bookbuild [-o book] [-d plies] [-n games] [-j threads] [-m megabytes] pgn...
+//   -o  the book to write, book.bin by default
+//   -d  how many plies of each game go into the book, 20 by default
+//   -n  moves played in fewer games are left out, 2 by default
+//   -j  number of threads replaying games, defaults to the number of cores
+//   -m  memory for the move counts, 256 MB by default: beyond it they are
+//       spilled to sorted run files next to the book, merged at the end
+//       0 spills every count as soon as it's made, to test the merge
+// a pgn of - reads standard input
+//
+// a move's weight is twice the games the player making it won plus the games
+// drawn, its learn field the number of games it was played in
+// games without a result or starting from a set up position are skipped, a
+// game with an illegal move counts up to that move
+//
+// the counts are split into shards by the high bits of the position key, so
+// each shard holds a range of keys: merging and writing them one after the
+// other writes the whole book in key order
+
+const int shardBits = 6;
+const int numShards = 1 << shardBits;
+// records a thread collects for a shard before taking its lock
+const std::size_t flushSize = 1024;
+// rough memory taken by a count, for -m
+const std::size_t bytesPerCount = 64;
+
+struct Record {
+  uint64_t key;
+  uint16_t move;
+  uint32_t games, wins, draws;
+  bool operator<(const Record &other) const {
+    return key < other.key || (key == other.key && move < other.move);
+  }
+  bool sameMove(const Record &other) const {
+    return key == other.key && move == other.move;
+  }
+};
+
+struct MoveKey {
+  uint64_t key;
+  uint16_t move;
+  bool operator==(const MoveKey &other) const {
+    return key == other.key && move == other.move;
+  }
+};
+
+struct MoveKeyHash {
+  std::size_t operator()(const MoveKey &moveKey) const {
+    return moveKey.key ^ moveKey.move * 0x9e3779b97f4a7c15ULL;
+  }
+};
+
+struct Counts {
+  uint32_t games = 0, wins = 0, draws = 0;
+};
+
+struct Shard {
+  std::mutex mutex;
+  std::unordered_map<MoveKey, Counts, MoveKeyHash> counts;
+  // sorted run files spilled so far
+  std::vector<std::string> runs;
+};
+
+struct Build {
+  std::string output;
+  int maxPlies = 20;
+  uint32_t minGames = 2;
+  std::size_t maxCountsPerShard = 0;
+  std::vector<Shard> shards = std::vector<Shard>(numShards);
+  std::atomic<uint64_t> games{ 0 }, skipped{ 0 }, illegal{ 0 }, positions{ 0 }, spills{ 0 };
+};
+
+// game texts on their way from the reader to the workers, bounded so a fast
+// reader can't fill the memory
+class GameQueue {
+  std::mutex mutex;
+  std::condition_variable notEmpty, notFull;
+  std::deque<std::string> games;
+  std::size_t capacity;
+  bool closed = false;
+public:
+  explicit GameQueue(std::size_t capacity) : capacity{ capacity } {}
+  void push(std::string game) {
+    std::unique_lock<std::mutex> lock(mutex);
+    notFull.wait(lock, [this] { return games.size() < capacity; });
+    games.push_back(std::move(game));
+    notEmpty.notify_one();
+  }
+  // returns false once the queue is closed and empty
+  bool pop(std::string &game) {
+    std::unique_lock<std::mutex> lock(mutex);
+    notEmpty.wait(lock, [this] { return !games.empty() || closed; });
+    if (games.empty()) return false;
+    game = std::move(games.front());
+    games.pop_front();
+    notFull.notify_one();
+    return true;
+  }
+  // no more games will be pushed
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    notEmpty.notify_all();
+  }
+};
+
+int shardOf(uint64_t key) {
+  return key >> (64 - shardBits);
+}
+
+std::vector<Record> sortedRecords(Shard &shard) {
+  std::vector<Record> records;
+  records.reserve(shard.counts.size());
+  for (const auto &count : shard.counts) {
+    records.push_back({ count.first.key, count.first.move,
+      count.second.games, count.second.wins, count.second.draws });
+  }
+  std::sort(records.begin(), records.end());
+  return records;
+}
+
+// writes the counts of shard to a new run file and forgets them
+// the caller holds the shard's lock
+void spill(Build &build, Shard &shard, int index) {
+  std::string path = build.output + ".shard" + std::to_string(index)
+    + ".run" + std::to_string(shard.runs.size());
+  std::vector<Record> records = sortedRecords(shard);
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(Record));
+  if (!file) throw std::runtime_error("cannot write " + path);
+  shard.runs.push_back(path);
+  shard.counts.clear();
+  ++build.spills;
+}
+
+void flush(Build &build, int index, std::vector<Record> &records) {
+  Shard &shard = build.shards[index];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  for (const Record &record : records) {
+    Counts &counts = shard.counts[{ record.key, record.move }];
+    counts.games += record.games;
+    counts.wins += record.wins;
+    counts.draws += record.draws;
+  }
+  records.clear();
+  if (shard.counts.size() > build.maxCountsPerShard) spill(build, shard, index);
+}
+
+// replays games from queue, counting the moves of their first plies
+void work(Build &build, GameQueue &queue) {
+  std::vector<std::vector<Record>> buffers(numShards);
+  // a shard can't hold a whole batch under a tiny memory limit
+  std::size_t batchSize = std::min(flushSize, build.maxCountsPerShard + 1);
+  std::string text;
+  while (queue.pop(text)) {
+    PgnGame game = parsePgn(text);
+    if (game.result == PgnGame::UNKNOWN || !game.fen.empty()) {
+      ++build.skipped;
+      continue;
+    }
+    Board board;
+    int plies = 0;
+    try {
+      for (const std::string &san : game.moves) {
+        if (plies >= build.maxPlies) break;
+        Move move = parseSan(board, san);
+        Colour mover = board.getTurn();
+        bool won = (game.result == PgnGame::WHITE_WINS && mover == WHITE)
+          || (game.result == PgnGame::BLACK_WINS && mover == BLACK);
+        Record record{ polyglotKey(board), OpeningBook::encodeMove(board, move), 1,
+          won ? 1u : 0u, game.result == PgnGame::DRAW ? 1u : 0u };
+        board.move(move);
+        ++plies;
+        std::vector<Record> &buffer = buffers[shardOf(record.key)];
+        buffer.push_back(record);
+        if (buffer.size() >= batchSize) flush(build, shardOf(record.key), buffer);
+      }
+    } catch (std::logic_error &) {
+      ++build.illegal;
+    }
+    ++build.games;
+    build.positions += plies;
+  }
+  for (int i = 0; i < numShards; ++i) {
+    if (!buffers[i].empty()) flush(build, i, buffers[i]);
+  }
+}
+
+// reads a run file a block at a time
+// throws std::runtime_error if the file can't be read or is truncated
+class RunReader {
+  std::string path;
+  std::ifstream file;
+  std::vector<Record> block;
+  std::size_t next = 0;
+public:
+  explicit RunReader(const std::string &path) : path{ path }, file(path, std::ios::binary) {
+    if (!file) throw std::runtime_error("cannot read " + path);
+  }
+  // returns false at the end of the run
+  bool read(Record &record) {
+    if (next == block.size()) {
+      block.resize(4096);
+      file.read(reinterpret_cast<char *>(block.data()), block.size() * sizeof(Record));
+      // a run is written whole, part of a record means it was cut short
+      if (file.bad() || file.gcount() % sizeof(Record) != 0) {
+        throw std::runtime_error("truncated run file " + path);
+      }
+      block.resize(file.gcount() / sizeof(Record));
+      next = 0;
+      if (block.empty()) return false;
+    }
+    record = block[next++];
+    return true;
+  }
+};
+
+// merges the counts of shard, in memory and in its run files, writing the
+// moves played often enough to out in key order
+// returns the number of entries written
+uint64_t writeShard(Build &build, int index, std::ostream &out) {
+  Shard &shard = build.shards[index];
+  uint64_t written = 0;
+  Record merged{ 0, 0, 0, 0, 0 };
+  auto emit = [&build, &out, &written](const Record &record) {
+    if (record.games < build.minGames) return;
+    uint32_t weight = std::min<uint32_t>(0xffff, 2 * record.wins + record.draws);
+    OpeningBook::writeEntry(out, record.key, record.move, weight, record.games);
+    ++written;
+  };
+  auto add = [&merged, &emit](const Record &record) {
+    if (merged.games && merged.sameMove(record)) {
+      merged.games += record.games;
+      merged.wins += record.wins;
+      merged.draws += record.draws;
+    } else {
+      if (merged.games) emit(merged);
+      merged = record;
+    }
+  };
+
+  if (shard.runs.empty()) {
+    for (const Record &record : sortedRecords(shard)) add(record);
+  } else {
+    // everything goes through the runs, so the merge has a single kind of
+    // input
+    if (!shard.counts.empty()) spill(build, shard, index);
+    std::vector<std::unique_ptr<RunReader>> readers;
+    using Head = std::pair<Record, std::size_t>;
+    auto later = [](const Head &a, const Head &b) { return b.first < a.first; };
+    std::priority_queue<Head, std::vector<Head>, decltype(later)> heads(later);
+    for (const std::string &path : shard.runs) {
+      readers.push_back(std::make_unique<RunReader>(path));
+      Record record;
+      if (readers.back()->read(record)) heads.emplace(record, readers.size() - 1);
+    }
+    while (!heads.empty()) {
+      Head head = heads.top();
+      heads.pop();
+      add(head.first);
+      Record record;
+      if (readers[head.second]->read(record)) heads.emplace(record, head.second);
+    }
+    readers.clear();
+    for (const std::string &path : shard.runs) std::remove(path.c_str());
+  }
+  if (merged.games) emit(merged);
+  shard.counts.clear();
+  return written;
+}
+
+void usage() {
+  std::cerr << "usage: bookbuild [-o book] [-d plies] [-n games] [-j threads] [-m megabytes] pgn..." << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  Build build;
+  build.output = "book.bin";
+  unsigned numThreads = std::max(1u, std::thread::hardware_concurrency());
+  std::size_t megabytes = 256;
+  std::vector<std::string> paths;
+  for (int i = 1; i < argc; ++i) {
+    bool hasValue = i + 1 < argc;
+    if (std::strcmp(argv[i], "-o") == 0 && hasValue) {
+      build.output = argv[++i];
+    } else if (std::strcmp(argv[i], "-d") == 0 && hasValue) {
+      build.maxPlies = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "-n") == 0 && hasValue) {
+      build.minGames = std::max(1, std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "-j") == 0 && hasValue) {
+      numThreads = std::max(1, std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "-m") == 0 && hasValue) {
+      megabytes = std::max(0, std::atoi(argv[++i]));
+    } else if (argv[i][0] == '-' && argv[i][1]) {
+      usage();
+      return 1;
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  if (paths.empty()) {
+    usage();
+    return 1;
+  }
+  build.maxCountsPerShard = megabytes
+    ? std::max<std::size_t>(1, megabytes * 1024 * 1024 / bytesPerCount / numShards) : 0;
+
+  auto start = std::chrono::steady_clock::now();
+  GameQueue queue(256 * numThreads);
+  std::vector<std::thread> workers;
+  // a worker that fails (a run file that can't be written) stops the build
+  std::atomic<bool> failed{ false };
+  for (unsigned i = 0; i < numThreads; ++i) {
+    workers.emplace_back([&build, &queue, &failed] {
+      try {
+        work(build, queue);
+      } catch (std::runtime_error &e) {
+        std::cerr << "bookbuild: " << e.what() << std::endl;
+        failed = true;
+        // keep draining so the reader isn't left waiting
+        std::string game;
+        while (queue.pop(game)) {}
+      }
+    });
+  }
+  for (const std::string &path : paths) {
+    std::ifstream file;
+    if (path != "-") {
+      file.open(path);
+      if (!file) {
+        std::cerr << "bookbuild: cannot open " << path << std::endl;
+        failed = true;
+        continue;
+      }
+    }
+    PgnReader reader(path == "-" ? std::cin : file);
+    std::string text;
+    while (reader.next(text)) queue.push(std::move(text));
+  }
+  queue.close();
+  for (std::thread &worker : workers) worker.join();
+  if (failed) return 1;
+
+  std::ofstream book(build.output, std::ios::binary);
+  uint64_t entries = 0;
+  try {
+    for (int i = 0; i < numShards; ++i) entries += writeShard(build, i, book);
+  } catch (std::runtime_error &e) {
+    std::cerr << "bookbuild: " << e.what() << std::endl;
+    return 1;
+  }
+  book.close();
+  if (!book) {
+    std::cerr << "bookbuild: cannot write " << build.output << std::endl;
+    return 1;
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << build.games << " games (" << build.skipped << " skipped, " << build.illegal
+    << " with illegal moves), " << build.positions << " positions, " << build.spills
+    << " spills, " << entries << " entries written to " << build.output
+    << " in " << seconds << " s" << std::endl;
+}
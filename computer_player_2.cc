@@ -18,37 +18,15 @@ int ComputerPlayer2::boardPoints(const Board &board) {
   case Board::CHECK:
     points += 5;
   case Board::NORMAL:
-    for (int row = 0; row < 8; ++row) {
-      for (int col = 0; col < 8; ++col) {
-        const Piece *piece = board.at(row, col);
-        if (!piece) continue;
-        if (piece->colour == board.getTurn()) {
-          switch (piece->type) {
-          case PAWN:
-            points -= 1;
-            break;
-          case ROOK:
-            points -= 5;
-            break;
-          case KNIGHT:
-          case BISHOP:
-            points -= 3;
-            break;
-          case QUEEN:
-            points -= 9;
-            break;
-          case KING:
-            // both players should still have their king, meaningless to add points
-            break;
-          }
-        }
-      }
-    }
+    // material is kept in centipawns, this player counts whole pawns
+    points -= board.getMaterial(board.getTurn()) / 100;
     break;
   case Board::CHECKMATE:
     points = std::numeric_limits<int>::max();
     break;
   case Board::STALEMATE:
+  case Board::REPETITION:
+  case Board::FIFTY_MOVES:
     // assign 0 points, as initialized
     break;
   case Board::RESIGNED:
@@ -7,8 +7,9 @@
 
 #include "computer_player_3.h"
 
-ComputerPlayer3::ComputerPlayer3()
+ComputerPlayer3::ComputerPlayer3(StopToken stopToken)
   : rng(std::chrono::system_clock::now().time_since_epoch().count())
+  , stopToken{ stopToken }
 {}
 
 int ComputerPlayer3::boardPoints(const Board &board) {
@@ -18,47 +19,16 @@ int ComputerPlayer3::boardPoints(const Board &board) {
     // we get checked
     points -= 5;
   case Board::NORMAL:
-    for (int row = 0; row < 8; ++row) {
-      for (int col = 0; col < 8; ++col) {
-        const Piece *piece = board.at(row, col);
-        if (!piece) continue;
-        int value = 0;
-        switch (piece->type) {
-        case PAWN:
-          value = 1;
-          break;
-        case ROOK:
-          value = 5;
-          break;
-        case KNIGHT:
-          value = 3;
-          break;
-        case BISHOP:
-          value = 3;
-          break;
-        case QUEEN:
-          value = 9;
-          break;
-        case KING:
-          // king can never be captured, meaningless to assign value
-          // value is 0 as initialized
-          break;
-        }
-        if (piece->colour == board.getTurn()) {
-          // our piece
-          points += value;
-        } else {
-          // enemy's piece
-          points -= value;
-        }
-      }
-    }
+    // material is kept in centipawns, this player counts whole pawns
+    points += (board.getMaterial(board.getTurn()) - board.getMaterial(!board.getTurn())) / 100;
     break;
   case Board::CHECKMATE:
     // we get checkmated, negative infinity points
     points = std::numeric_limits<int>::min();
     break;
   case Board::STALEMATE:
+  case Board::REPETITION:
+  case Board::FIFTY_MOVES:
     // assign 0 points, as initialized
     break;
   case Board::RESIGNED:
@@ -80,6 +50,10 @@ int ComputerPlayer3::movePoints(Board &board, const Move &move) {
       int worstPoints = std::numeric_limits<int>::max();
       // there should be moves since state is normal
       for (const Move &nextMove : board.legalMoves()) {
+        if (stopToken.stopRequested()) {
+          board.undo();
+          return std::numeric_limits<int>::min();
+        }
         board.move(nextMove);
         worstPoints = std::min(worstPoints, boardPoints(board));
         board.undo();
@@ -91,6 +65,8 @@ int ComputerPlayer3::movePoints(Board &board, const Move &move) {
     points = std::numeric_limits<int>::max();
     break;
   case Board::STALEMATE:
+  case Board::REPETITION:
+  case Board::FIFTY_MOVES:
     points = 0;
     break;
   case Board::RESIGNED:
@@ -109,6 +85,7 @@ std::unique_ptr<Action> ComputerPlayer3::getAction(const Board &board) {
   Move bestMove = moves.at(randomIndex);
   int bestPoints = movePoints(tmpBoard, bestMove);
   for(const Move &move : moves) {
+    if (stopToken.stopRequested()) break;
     int points = movePoints(tmpBoard, move);
     if (points > bestPoints) {
       bestMove = move;
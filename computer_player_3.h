@@ -4,16 +4,22 @@
 #include <random>
 
 #include "player.h"
+#include "stop_token.h"
 
 class Board;
 
 class ComputerPlayer3 : public Player {
   std::mt19937_64 rng;
+  StopToken stopToken;
   // should only be called at 2 moves into the future
   static int boardPoints(const Board &board);
-  static int movePoints(Board &board, const Move &move);
+  // returns the lowest possible points if a stop is requested before all
+  // replies are considered
+  int movePoints(Board &board, const Move &move);
 public:
-  ComputerPlayer3();
+  // getAction returns the best move so far when a stop is requested on (a
+  // copy of) stopToken
+  ComputerPlayer3(StopToken stopToken = StopToken());
   std::unique_ptr<Action> getAction(const Board &board) override;
 };
 
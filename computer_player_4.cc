@@ -1,128 +1,285 @@
 #include <algorithm>
 #include <chrono>
-#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
 
 #include "board.h"
+#include "searcher.h"
 
 #include "computer_player_4.h"
 
-ComputerPlayer4::ComputerPlayer4()
+struct ComputerPlayer4::Search {
+  SharedSearch shared;
+  // the main searcher first
+  std::vector<std::unique_ptr<Searcher>> searchers;
+  // threads[i] runs searchers[i]
+  std::vector<std::thread> threads;
+  // of the searched position
+  uint64_t hash;
+  // when the search started, and the table statistics then
+  std::chrono::steady_clock::time_point started;
+  uint64_t ttProbes, ttHits;
+  uint64_t pawnProbes, pawnHits;
+  uint64_t evalProbes, evalHits;
+  Search(SearchLimits limits, SearchOptions options, TranspositionTable &tt,
+    const EvalCache &evalCache, StopToken stopToken, bool pondering, uint64_t hash)
+    : shared(limits, options, tt, stopToken, pondering)
+    , hash{ hash }
+    , started{ std::chrono::steady_clock::now() }
+    , ttProbes{ tt.numProbes() }
+    , ttHits{ tt.numHits() }
+    , pawnProbes{ 0 }
+    , pawnHits{ 0 }
+    , evalProbes{ evalCache.numProbes() }
+    , evalHits{ evalCache.numHits() }
+  {}
+};
+
+namespace {
+
+std::shared_ptr<const Network> loadNetwork(const std::string &path) {
+  if (path.empty()) return nullptr;
+  return Network::load(path);
+}
+
+}
+
+ComputerPlayer4::ComputerPlayer4(SearchLimits limits, SearchOptions options,
+    StopToken stopToken)
   : rng(std::chrono::system_clock::now().time_since_epoch().count())
+  , limits{ limits }
+  , options{ options }
+  , stopToken{ stopToken }
+  , tt(options.hashMegabytes)
+  , evalCache(options.evalCacheMegabytes)
+  , orderers(std::max(1, options.threads))
+  , evaluators(std::max(1, options.threads), Evaluator(loadNetwork(options.networkFile),
+    options.evalCacheMegabytes ? &evalCache : nullptr))
+  , book{ options.bookFile.empty() ? nullptr : std::make_unique<OpeningBook>(options.bookFile) }
+  , trace(options.traceEvents ? std::max(1, options.threads) : 0, options.traceEvents)
+  , score{ 0 }
+  , expectedHash{ 0 }
+  , ponderHits{ 0 }
 {}
 
-int ComputerPlayer4::boardPoints(const Board &board, bool maximizePlayer) {
-  int points = 0;
-  switch (board.getState()) {
-  case Board::CHECK:
-    // phasing player gets checked
-    points -= 5;
-  case Board::NORMAL:
-    for (int row = 0; row < 8; ++row) {
-      for (int col = 0; col < 8; ++col) {
-        const Piece *piece = board.at(row, col);
-        if (!piece) continue;
-        int value = 0;
-        switch (piece->type) {
-        case PAWN:
-          value = 1;
-          break;
-        case ROOK:
-          value = 5;
-          break;
-        case KNIGHT:
-        case BISHOP:
-          value = 3;
-          break;
-        case QUEEN:
-          value = 9;
-          break;
-        case KING:
-          // king can never be captured, meaningless to assign value
-          // value is 0 as initialized
-          break;
-        }
-        if (piece->colour == board.getTurn()) {
-          // phasing player's piece
-          points += value;
-        } else {
-          // phasing player's opponent's piece
-          points -= value;
-        }
-      }
+ComputerPlayer4::~ComputerPlayer4() {
+  stopPondering();
+}
+
+std::unique_ptr<ComputerPlayer4::Search> ComputerPlayer4::startSearch(
+    const Board &board, std::vector<Move> moves, bool pondering) {
+  tt.newSearch();
+  for (MoveOrderer &orderer : orderers) orderer.newSearch();
+  trace.clear();
+
+  int startDepth = 1, expectedScore = 0;
+  TranspositionTable::Entry entry;
+  const Move *firstMove = nullptr;
+  // the root entry describes a search of all moves, a search excluding some
+  // (see analyse) would start from the depth and score of a move it can't
+  // play
+  bool allMoves = moves.size() == board.legalMoves().size();
+  if (allMoves && tt.probe(board.getHash(), entry) && entry.bestMove) {
+    firstMove = entry.bestMove.get();
+    if (entry.bound == TranspositionTable::EXACT && board.isLegalMove(*entry.bestMove)) {
+      // the iterations up to the entry's depth are mostly answered by the
+      // table, redoing the last one gets the principal variation back
+      // if the time runs out first, the entry's move is played (see
+      // Searcher::run)
+      startDepth = std::max(1, std::min(entry.depth, limits.maxDepth));
+      expectedScore = entry.score;
     }
-    break;
-  case Board::CHECKMATE:
-    // phasing player gets checkmated, negative infinity points
-    // use negative int max so we can flip the sign
-    points = -std::numeric_limits<int>::max();
-    break;
-  case Board::STALEMATE:
-    // assign 0 points, as initialized
-    break;
-  case Board::RESIGNED:
-    // if the enemy resigns (they won't, but theoretically) phasing player
-    // gets infinite points
-    points = std::numeric_limits<int>::max();
-    break;
+  } else if (board.getHash() == expectedHash && !expectedLine.empty()) {
+    firstMove = &expectedLine.front();
   }
-  if (maximizePlayer) {
-    // phasing player is minimizing player
-    return points;
-  } else {
-    return -points;
+
+  // shuffle first so that equally good moves are picked at random
+  std::shuffle(moves.begin(), moves.end(), rng);
+  orderers.front().order(board, moves, firstMove, 0);
+
+  auto search = std::make_unique<Search>(limits, options, tt, evalCache, stopToken, pondering, board.getHash());
+  for (const Evaluator &evaluator : evaluators) {
+    search->pawnProbes += evaluator.pawnTable().numProbes();
+    search->pawnHits += evaluator.pawnTable().numHits();
+  }
+  auto traceOf = [this](int thread) { return trace.numThreads() ? &trace.thread(thread) : nullptr; };
+  search->searchers.push_back(std::make_unique<Searcher>(search->shared, board, orderers.front(), evaluators.front(), true, moves, traceOf(0)));
+  for (size_t i = 1; i < orderers.size(); ++i) {
+    // helpers search the root moves in a different order, and every other
+    // helper one ply deeper, so they don't all search the same positions at
+    // the same time
+    std::vector<Move> helperMoves = moves;
+    std::shuffle(helperMoves.begin(), helperMoves.end(), rng);
+    search->searchers.push_back(std::make_unique<Searcher>(search->shared, board, orderers[i], evaluators[i], false, std::move(helperMoves), traceOf(i)));
+  }
+  for (size_t i = 0; i < search->searchers.size(); ++i) {
+    Searcher *searcher = search->searchers[i].get();
+    int depth = std::min(limits.maxDepth, startDepth + static_cast<int>(i % 2));
+    search->threads.emplace_back([searcher, depth, expectedScore] { searcher->run(depth, expectedScore); });
   }
+  return search;
 }
 
+Move ComputerPlayer4::finishSearch(Search &search) {
+  search.threads.front().join();
+  search.shared.stop = true;
+  for (size_t i = 1; i < search.threads.size(); ++i) search.threads[i].join();
+
+  const Searcher &main = *search.searchers.front();
+  Move best = main.bestMove();
+  pv = main.principalVariation();
+  // an iteration interrupted after finding a better move leaves the line of
+  // the previous one
+  if (pv.empty() || !(pv.front() == best)) pv.assign(1, best);
+  score = main.score();
+
+  for (const std::unique_ptr<Searcher> &searcher : search.searchers) {
+    stats.add(searcher->statistics());
+  }
+  // the helpers' depths say nothing about the result
+  stats.searches = 1;
+  stats.depth = main.depth();
+  stats.iterationMillis = main.statistics().iterationMillis;
+  stats.ttProbes = tt.numProbes() - search.ttProbes;
+  stats.ttHits = tt.numHits() - search.ttHits;
+  for (const Evaluator &evaluator : evaluators) {
+    stats.pawnProbes += evaluator.pawnTable().numProbes();
+    stats.pawnHits += evaluator.pawnTable().numHits();
+  }
+  stats.pawnProbes -= search.pawnProbes;
+  stats.pawnHits -= search.pawnHits;
+  stats.evalProbes = evalCache.numProbes() - search.evalProbes;
+  stats.evalHits = evalCache.numHits() - search.evalHits;
+  // includes the time spent pondering
+  stats.millis = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - search.started).count();
+  totals.add(stats);
+  // a trace that can't be written is lost, it must not cost the game
+  if (trace.numThreads() && !options.traceFile.empty()) {
+    trace.write(options.traceFile + "." + std::to_string(totals.searches));
+  }
+  return best;
+}
+
+std::unique_ptr<Action> ComputerPlayer4::getAction(const Board &board) {
+  stats = SearchStats();
+  pv.clear();
+  score = 0;
 
-int ComputerPlayer4::minimax(Board &board, int depth, int alpha, int beta, bool maximizePlayer) {
-  if(depth <= 0) return boardPoints(board, maximizePlayer);
   std::vector<Move> moves = board.legalMoves();
-  if (moves.empty()) return boardPoints(board, maximizePlayer);
-
-  if(maximizePlayer) {
-    int maxEval = std::numeric_limits<int>::min();
-    for (const Move &move : moves) {
-      board.move(move);
-      int eval = minimax(board, depth - 1, alpha, beta, !maximizePlayer);
-      board.undo();  
-      maxEval = std::max(maxEval, eval);
-      alpha = std::max(alpha, maxEval);
-      if(beta <= alpha) break;
+  if (moves.size() == 1) {
+    stopPondering();
+    return std::make_unique<Move>(moves.front());
+  }
+  if (book) {
+    std::unique_ptr<Move> move = book->pick(board, rng);
+    if (move) {
+      stopPondering();
+      return std::move(move);
     }
-    return maxEval;
+  }
+
+  std::unique_ptr<Search> search;
+  if (ponderSearch && ponderSearch->hash == board.getHash()) {
+    // the opponent played the predicted move
+    search = std::move(ponderSearch);
+    search->shared.ponderHit();
+    ++ponderHits;
   } else {
-    int minEval = std::numeric_limits<int>::max();
-    for (const Move &move : moves) {
-      board.move(move);
-      int eval = minimax(board, depth - 1, alpha, beta, !maximizePlayer);
-      board.undo();  
-      minEval = std::min(minEval, eval);
-      beta = std::min(beta, minEval);
-      if(beta <= alpha) break;
-    }
-    return minEval;
+    stopPondering();
+    search = startSearch(board, std::move(moves), false);
+  }
+  Move best = finishSearch(*search);
+
+  expectedLine.clear();
+  if (pv.size() >= 3) {
+    Board expected = board;
+    expected.move(pv[0]);
+    expected.move(pv[1]);
+    expectedHash = expected.getHash();
+    expectedLine.assign(pv.begin() + 2, pv.end());
   }
+  return std::make_unique<Move>(best);
 }
 
-std::unique_ptr<Action> ComputerPlayer4::getAction(const Board &board) {
-  const int depth = 2;
+std::vector<AnalysisLine> ComputerPlayer4::analyse(const Board &board, int numLines) {
+  stopPondering();
+  std::vector<AnalysisLine> lines;
+  SearchStats analysisStats;
   std::vector<Move> moves = board.legalMoves();
-  int randomIndex = rng() % moves.size();
-  Board tmpBoard = board;
-  Move bestMove = moves.at(randomIndex);
-  tmpBoard.move(bestMove);
-  int bestPoints = minimax(tmpBoard, depth, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), false);
-  tmpBoard.undo();
-
-  for(const Move &move : moves) {
-    tmpBoard.move(move);
-    int points = minimax(tmpBoard, depth, bestPoints, std::numeric_limits<int>::max(), false);
-    if (points > bestPoints) {
-      bestMove = move;
-      bestPoints = points;
-    }
-    tmpBoard.undo();
+  while (static_cast<int>(lines.size()) < numLines && !moves.empty()) {
+    stats = SearchStats();
+    Move best = finishSearch(*startSearch(board, moves, false));
+    analysisStats.add(stats);
+    lines.push_back(AnalysisLine{ pv, score, stats.depth });
+    moves.erase(std::find(moves.begin(), moves.end(), best));
+  }
+  stats = analysisStats;
+  // principalVariation() and lastScore() describe the best line
+  if (!lines.empty()) {
+    pv = lines.front().pv;
+    score = lines.front().score;
   }
+  return lines;
+}
+
+void ComputerPlayer4::startPondering(const Board &board) {
+  stopPondering();
+  if (!options.ponder || pv.size() < 2 || board.gameOver()) return;
+  const Move &reply = pv[1];
+  if (!board.isLegalMove(reply)) return;
+  Board predicted = board;
+  predicted.move(reply);
+  if (predicted.gameOver()) return;
+  ponderSearch = startSearch(predicted, predicted.legalMoves(), true);
+}
+
+void ComputerPlayer4::stopPondering() {
+  if (!ponderSearch) return;
+  ponderSearch->shared.stop = true;
+  for (std::thread &thread : ponderSearch->threads) thread.join();
+  ponderSearch.reset();
+}
+
+void ComputerPlayer4::reportMove(std::ostream &out, Colour colour) const {
+  if (!options.reportStats || !stats.searches) return;
+  out << (colour == WHITE ? "White" : "Black") << " searched: " << stats << std::endl;
+}
+
+void ComputerPlayer4::reportGame(std::ostream &out, Colour colour) const {
+  if (!options.reportStats || !totals.searches) return;
+  out << (colour == WHITE ? "White" : "Black") << " searched in all: " << totals << std::endl;
+}
+
+const TranspositionTable &ComputerPlayer4::transpositionTable() const {
+  return tt;
+}
+
+const EvalCache &ComputerPlayer4::evaluationCache() const {
+  return evalCache;
+}
+
+const SearchTrace &ComputerPlayer4::lastTrace() const {
+  return trace;
+}
+
+const std::vector<Move> &ComputerPlayer4::principalVariation() const {
+  return pv;
+}
+
+int ComputerPlayer4::lastScore() const {
+  return score;
+}
+
+const SearchStats &ComputerPlayer4::lastStats() const {
+  return stats;
+}
+
+const SearchStats &ComputerPlayer4::gameStats() const {
+  return totals;
+}
 
-  return std::make_unique<Move>(bestMove);
+uint64_t ComputerPlayer4::numPonderHits() const {
+  return ponderHits;
 }
@@ -1,20 +1,140 @@
 #ifndef COMPUTER_PLAYER_4_H
 #define COMPUTER_PLAYER_4_H
 
+#include <memory>
 #include <random>
+#include <vector>
 
+#include "eval_cache.h"
+#include "evaluator.h"
+#include "move_orderer.h"
+#include "opening_book.h"
 #include "player.h"
+#include "search_limits.h"
+#include "search_options.h"
+#include "search_stats.h"
+#include "search_trace.h"
+#include "stop_token.h"
+#include "transposition_table.h"
 
 class Board;
 
+// a candidate move found by ComputerPlayer4::analyse
+struct AnalysisLine {
+  // the expected line of play, starting with the candidate move
+  std::vector<Move> pv;
+  // points from the perspective of the player to move, see score.h for
+  // mate scores
+  int score;
+  // in plies
+  int depth;
+};
+
+// searches with iterative deepening alpha-beta on options.threads threads,
+// see Searcher
+// the transposition table, the move history and the expected line of play
+// are kept from move to move, so each search starts where the last left off
+// with options.ponder, it also searches while the opponent thinks, see
+// startPondering
 class ComputerPlayer4 : public Player {
+  // a search running in the background, see computer_player_4.cc
+  struct Search;
   std::mt19937_64 rng;
-  // maximizePlayer is true if we are evaluating after a move by the maximizing player
-  static int boardPoints(const Board &board, bool maximizePlayer);
-  static int minimax(Board &board, int depth, int alpha, int beta, bool maximizePlayer);
+  SearchLimits limits;
+  SearchOptions options;
+  StopToken stopToken;
+  // kept between moves, positions searched last move are often searched again
+  TranspositionTable tt;
+  // also kept between moves, but only used if options.evalCacheMegabytes is
+  // not 0
+  EvalCache evalCache;
+  // one per thread
+  std::vector<MoveOrderer> orderers;
+  // one per thread, the pawn tables are kept between moves too, all share
+  // the network of options.networkFile if there is one
+  std::vector<Evaluator> evaluators;
+  // null unless options.bookFile is set
+  std::unique_ptr<OpeningBook> book;
+  // of the last search, with no threads unless options.traceEvents is set
+  SearchTrace trace;
+  // result of the last search
+  std::vector<Move> pv;
+  int score;
+  // the position the last principal variation expects after the opponent's
+  // reply, and the rest of the line from there
+  uint64_t expectedHash;
+  std::vector<Move> expectedLine;
+  // of the last search, and summed over every search since construction
+  SearchStats stats, totals;
+  // the search of the position the opponent is expected to leave us in, null
+  // when not pondering
+  std::unique_ptr<Search> ponderSearch;
+  uint64_t ponderHits;
+  // starts searching board on every thread, over moves, its legal moves or
+  // some of them
+  // a position searched before (the reply the last search expected, or one
+  // the game returned to by undo) starts from the transposition table entry
+  // that search left: its best move first, from the depth it reached, with
+  // the aspiration window around its score
+  std::unique_ptr<Search> startSearch(const Board &board, std::vector<Move> moves, bool pondering);
+  // waits for the main searcher to reach a limit, stops the others and keeps
+  // the results
+  // returns the best move
+  Move finishSearch(Search &search);
 public:
-  ComputerPlayer4();
+  // getAction returns the best move so far when a stop is requested on (a
+  // copy of) stopToken, it also ends pondering
+  // throws std::logic_error if options.networkFile or options.bookFile can't
+  // be loaded
+  ComputerPlayer4(SearchLimits limits = SearchLimits(), SearchOptions options = SearchOptions(),
+    StopToken stopToken = StopToken());
+  ~ComputerPlayer4();
+  // plays a book move if there is one, otherwise searches until a limit is
+  // reached, then plays the best move of the deepest iteration the main
+  // thread completed
+  // if it was pondering on board, the ponder search carries on with the
+  // limits applying from now (ponderhit), otherwise it is discarded
   std::unique_ptr<Action> getAction(const Board &board) override;
+  // board is the position after the engine's move: searches, in the
+  // background, the position after the reply the last principal variation
+  // predicts
+  // does nothing unless options.ponder is set
+  void startPondering(const Board &board) override;
+  void stopPondering() override;
+  // with options.reportStats, print lastStats() after a searched move and
+  // gameStats() at the end of the game
+  void reportMove(std::ostream &out, Colour colour) const override;
+  void reportGame(std::ostream &out, Colour colour) const override;
+  // finds the best numLines moves of board (fewer if it has fewer legal
+  // moves), best first
+  // each move gets a search of its own within the limits, the first of all
+  // legal moves and each later one of the moves not found yet, all sharing
+  // the transposition table
+  // only the first search stores the root position in the table, and the
+  // later ones start from depth 1 rather than from its entry
+  // lastStats() are the totals of all these searches
+  std::vector<AnalysisLine> analyse(const Board &board, int numLines);
+  const TranspositionTable &transpositionTable() const;
+  const EvalCache &evaluationCache() const;
+  // the events of the last search when options.traceEvents is set, see
+  // trace_convert.cc to view them
+  const SearchTrace &lastTrace() const;
+  // the line of play the last search expects, starting with the move it
+  // returned, empty if there was only one legal move
+  const std::vector<Move> &principalVariation() const;
+  // points of the last search from the engine's perspective, see score.h
+  // for mate scores
+  int lastScore() const;
+  // work done by the last search, summed over all threads (iteration times
+  // are the main thread's)
+  // a move with only one legal option, or played from the book, is not
+  // searched and has empty stats
+  const SearchStats &lastStats() const;
+  // work done by every search so far, a player plays a single game (see
+  // runSession) so these are the totals for the game
+  const SearchStats &gameStats() const;
+  // number of moves whose search started while the opponent was thinking
+  uint64_t numPonderHits() const;
 };
 
 #endif
@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#include "board.h"
+#include "move_orderer.h"
+#include "piece_values.h"
+
+#include "computer_player_5.h"
+
+struct ComputerPlayer5::Search {
+  std::chrono::steady_clock::time_point started;
+  // set when every thread should stop growing the tree
+  std::atomic<bool> stop;
+  std::atomic<uint64_t> playouts;
+  // deepest node reached, the root is at depth 0
+  std::atomic<int> depth;
+  Search() : started{ std::chrono::steady_clock::now() }, stop{ false }, playouts{ 0 }, depth{ 0 } {}
+};
+
+ComputerPlayer5::ComputerPlayer5(SearchLimits limits, MctsOptions options,
+    StopToken stopToken)
+  : rng(std::chrono::system_clock::now().time_since_epoch().count())
+  , limits{ limits }
+  , options{ options }
+  , stopToken{ stopToken }
+  , tree(options.maxTreeNodes)
+  , evaluators(std::max(1, options.threads))
+{}
+
+bool ComputerPlayer5::expand(MctsNode &node, const Board &board) {
+  std::vector<Move> moves;
+  if (!board.gameOver()) moves = board.legalMoves();
+  int64_t first = 0;
+  if (!moves.empty()) {
+    first = tree.allocate(moves.size());
+    if (first < 0) {
+      node.state.store(MctsNode::LEAF, std::memory_order_relaxed);
+      return false;
+    }
+  }
+  // priors: captures by the material they win, in pawns, every quiet move
+  // alike
+  std::vector<double> weights;
+  double totalWeight = 0;
+  for (const Move &move : moves) {
+    double weight = 1;
+    if (MoveOrderer::isCapture(board, move)) {
+      int gain = std::max(-2, std::min(9, MoveOrderer::staticExchange(board, move) / pieceValue(PAWN)));
+      weight = std::exp(0.5 * gain);
+    }
+    weights.push_back(weight);
+    totalWeight += weight;
+  }
+  for (size_t i = 0; i < moves.size(); ++i) {
+    MctsNode &child = tree[first + i];
+    child.move = moves[i];
+    child.prior = weights[i] / totalWeight;
+  }
+  node.firstChild = first;
+  node.numChildren = moves.size();
+  // publishes the children to threads reading the state
+  node.state.store(MctsNode::EXPANDED, std::memory_order_release);
+  return true;
+}
+
+uint32_t ComputerPlayer5::select(const MctsNode &node) const {
+  double parentVisits = node.visits.load(std::memory_order_relaxed)
+    + node.virtualLoss.load(std::memory_order_relaxed);
+  uint32_t best = node.firstChild;
+  double bestScore = -std::numeric_limits<double>::infinity();
+  for (uint32_t i = node.firstChild; i < node.firstChild + node.numChildren; ++i) {
+    const MctsNode &child = tree[i];
+    // playouts still running count as losses
+    double visits = child.visits.load(std::memory_order_relaxed)
+      + child.virtualLoss.load(std::memory_order_relaxed);
+    double value = child.valueSum.load(std::memory_order_relaxed) / static_cast<double>(MctsTree::valueScale);
+    double score;
+    if (options.selection == MctsOptions::UCT) {
+      if (visits == 0) return i;
+      score = value / visits + options.exploration * std::sqrt(std::log(parentVisits) / visits);
+    } else {
+      // an unvisited move is assumed to draw
+      double average = visits == 0 ? 0.5 : value / visits;
+      score = average + options.exploration * child.prior * std::sqrt(parentVisits) / (1 + visits);
+    }
+    if (score > bestScore) {
+      bestScore = score;
+      best = i;
+    }
+  }
+  return best;
+}
+
+Move ComputerPlayer5::playoutMove(const Board &board, std::mt19937_64 &threadRng) const {
+  std::vector<Move> moves = board.legalMoves();
+  // leave some randomness so playouts from the same position differ
+  if (options.playout == MctsOptions::CAPTURES && threadRng() % 4 != 0) {
+    const Move *best = nullptr;
+    int bestGain = 0;
+    for (const Move &move : moves) {
+      if (!MoveOrderer::isCapture(board, move)) continue;
+      int gain = MoveOrderer::staticExchange(board, move);
+      if (gain >= bestGain) {
+        best = &move;
+        bestGain = gain;
+      }
+    }
+    if (best) return *best;
+  }
+  return moves[threadRng() % moves.size()];
+}
+
+double ComputerPlayer5::playout(Board &board, std::mt19937_64 &threadRng, Evaluator &evaluator) const {
+  Colour player = board.getTurn();
+  for (int ply = 0; ply < options.playoutPlies && !board.gameOver(); ++ply) {
+    board.move(playoutMove(board, threadRng));
+  }
+  double result;
+  switch (board.getState()) {
+  case Board::CHECKMATE:
+    result = 0;
+    break;
+  case Board::STALEMATE:
+  case Board::REPETITION:
+  case Board::FIFTY_MOVES:
+    result = 0.5;
+    break;
+  case Board::RESIGNED:
+    result = 1;
+    break;
+  default:
+    // the chance of winning from the evaluation, a pawn up wins about 64%
+    result = 1 / (1 + std::exp(-evaluator.evaluate(board) / 400.0));
+    break;
+  }
+  // result is for the player to move at the end of the playout
+  return board.getTurn() == player ? result : 1 - result;
+}
+
+void ComputerPlayer5::grow(Search &search, const Board &root, std::mt19937_64 &threadRng, Evaluator &evaluator) {
+  std::vector<uint32_t> path;
+  while (!search.stop.load(std::memory_order_relaxed)) {
+    Board board = root;
+    path.assign(1, 0);
+    tree[0].virtualLoss.fetch_add(1, std::memory_order_relaxed);
+    // descend until a leaf, or a node another thread is expanding, which is
+    // played out as it is
+    bool full = false;
+    while (true) {
+      MctsNode &node = tree[path.back()];
+      uint8_t state = node.state.load(std::memory_order_acquire);
+      if (state == MctsNode::LEAF
+          && node.state.compare_exchange_strong(state, MctsNode::EXPANDING, std::memory_order_acquire)) {
+        full = !expand(node, board);
+        break;
+      }
+      if (state != MctsNode::EXPANDED || node.numChildren == 0) break;
+      uint32_t child = select(node);
+      tree[child].virtualLoss.fetch_add(1, std::memory_order_relaxed);
+      board.move(tree[child].move);
+      path.push_back(child);
+    }
+
+    // each node is credited with the result for the player who moved into it
+    double result = 1 - playout(board, threadRng, evaluator);
+    for (size_t i = path.size(); i-- > 0; ) {
+      MctsNode &node = tree[path[i]];
+      node.valueSum.fetch_add(std::llround(result * MctsTree::valueScale), std::memory_order_relaxed);
+      node.visits.fetch_add(1, std::memory_order_relaxed);
+      node.virtualLoss.fetch_sub(1, std::memory_order_relaxed);
+      result = 1 - result;
+    }
+
+    int depth = path.size() - 1;
+    int deepest = search.depth.load(std::memory_order_relaxed);
+    while (depth > deepest && !search.depth.compare_exchange_weak(deepest, depth, std::memory_order_relaxed)) {}
+    uint64_t playouts = search.playouts.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (full || stopToken.stopRequested()
+        || (limits.maxNodes && playouts >= limits.maxNodes)
+        || (limits.moveTime.count()
+          && std::chrono::steady_clock::now() - search.started >= limits.moveTime)) {
+      search.stop = true;
+    }
+  }
+}
+
+std::unique_ptr<Action> ComputerPlayer5::getAction(const Board &board) {
+  stats = SearchStats();
+  std::vector<Move> moves = board.legalMoves();
+  if (moves.size() == 1) return std::make_unique<Move>(moves.front());
+
+  tree.resize(std::max<std::size_t>(1 + moves.size(), options.maxTreeNodes));
+  tree.reset();
+  // the root is expanded up front, so there is always a child to play
+  expand(tree[0], board);
+  // shuffle so that equally good moves are picked at random
+  for (uint32_t i = tree[0].numChildren; i > 1; --i) {
+    MctsNode &child = tree[tree[0].firstChild + i - 1];
+    MctsNode &other = tree[tree[0].firstChild + rng() % i];
+    std::swap(child.move, other.move);
+    std::swap(child.prior, other.prior);
+  }
+
+  Search search;
+  std::vector<std::mt19937_64> rngs;
+  for (int i = 0; i < std::max(1, options.threads); ++i) rngs.emplace_back(rng());
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < rngs.size(); ++i) {
+    std::mt19937_64 *threadRng = &rngs[i];
+    Evaluator *evaluator = &evaluators[i];
+    threads.emplace_back([this, &search, &board, threadRng, evaluator] { grow(search, board, *threadRng, *evaluator); });
+  }
+  grow(search, board, rngs.front(), evaluators.front());
+  for (std::thread &thread : threads) thread.join();
+
+  const MctsNode &root = tree[0];
+  uint32_t best = root.firstChild;
+  for (uint32_t i = root.firstChild; i < root.firstChild + root.numChildren; ++i) {
+    if (tree[i].visits > tree[best].visits) best = i;
+  }
+
+  stats.searches = 1;
+  stats.nodes = search.playouts;
+  stats.selDepth = search.depth;
+  stats.millis = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - search.started).count();
+  return std::make_unique<Move>(tree[best].move);
+}
+
+const SearchStats &ComputerPlayer5::lastStats() const {
+  return stats;
+}
+
+std::size_t ComputerPlayer5::treeSize() const {
+  return tree.size();
+}
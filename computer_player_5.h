@@ -0,0 +1,65 @@
+#ifndef COMPUTER_PLAYER_5_H
+#define COMPUTER_PLAYER_5_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "evaluator.h"
+#include "mcts_options.h"
+#include "mcts_tree.h"
+#include "player.h"
+#include "search_limits.h"
+#include "search_stats.h"
+#include "stop_token.h"
+
+class Board;
+
+// Monte Carlo tree search: grows a tree of positions from the current one,
+// one playout at a time
+// each playout descends the tree picking children by options.selection,
+// expands the leaf it reaches, plays options.playoutPlies moves from there
+// and scores the result, which every node on the way down is credited with
+// the move played is the most visited child of the root
+// options.threads threads grow the same tree, see MctsNode::virtualLoss
+// the search stops after limits.maxNodes playouts (if not 0), after
+// limits.moveTime (if not 0), when the tree is full or when a stop is requested,
+// limits.maxDepth is unused
+class ComputerPlayer5 : public Player {
+  // state of a running search, see computer_player_5.cc
+  struct Search;
+  std::mt19937_64 rng;
+  SearchLimits limits;
+  MctsOptions options;
+  StopToken stopToken;
+  MctsTree tree;
+  // one per thread, for scoring playouts
+  std::vector<Evaluator> evaluators;
+  SearchStats stats;
+  // generates the children of node, whose position is board, and marks it
+  // expanded
+  // returns false if the tree is full, leaving node a leaf
+  bool expand(MctsNode &node, const Board &board);
+  // index of the child of node to descend into
+  uint32_t select(const MctsNode &node) const;
+  // plays out board and returns the result for the player whose turn it is
+  // (1 win, 0.5 draw, 0 loss)
+  double playout(Board &board, std::mt19937_64 &threadRng, Evaluator &evaluator) const;
+  Move playoutMove(const Board &board, std::mt19937_64 &threadRng) const;
+  // runs playouts from root until the search stops
+  void grow(Search &search, const Board &root, std::mt19937_64 &threadRng, Evaluator &evaluator);
+public:
+  // getAction returns the best move so far when a stop is requested on (a
+  // copy of) stopToken
+  ComputerPlayer5(SearchLimits limits = SearchLimits(), MctsOptions options = MctsOptions(),
+    StopToken stopToken = StopToken());
+  std::unique_ptr<Action> getAction(const Board &board) override;
+  // work done by the last search, where nodes are playouts and selDepth is
+  // the depth of the tree
+  // a move with only one legal option is not searched and has empty stats
+  const SearchStats &lastStats() const;
+  // number of nodes in the tree of the last search
+  std::size_t treeSize() const;
+};
+
+#endif
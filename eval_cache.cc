@@ -0,0 +1,64 @@
+#include <algorithm>
+
+#include "eval_cache.h"
+
+namespace {
+
+// the low 16 bits of an entry hold the score, the others the same bits of
+// the key
+const uint64_t keyMask = ~static_cast<uint64_t>(0xffff);
+
+}
+
+EvalCache::EvalCache(std::size_t megabytes) : mask{ 0 }, probes{ 0 }, hits{ 0 } {
+  resize(megabytes);
+}
+
+void EvalCache::resize(std::size_t megabytes) {
+  std::size_t wanted = std::max<std::size_t>(1, megabytes * 1024 * 1024 / sizeof(uint64_t));
+  std::size_t size = 1;
+  while (size * 2 <= wanted) size *= 2;
+  entries = std::make_unique<std::atomic<uint64_t>[]>(size);
+  mask = size - 1;
+  clear();
+}
+
+void EvalCache::clear() {
+  // an empty entry only matches keys whose high bits are all 0, which are
+  // as rare as any other collision
+  for (uint64_t i = 0; i <= mask; ++i) entries[i].store(0, std::memory_order_relaxed);
+  probes = 0;
+  hits = 0;
+}
+
+bool EvalCache::probe(uint64_t key, int &score) {
+  probes.fetch_add(1, std::memory_order_relaxed);
+  uint64_t entry = entries[key & mask].load(std::memory_order_relaxed);
+  if ((entry & keyMask) != (key & keyMask)) return false;
+  hits.fetch_add(1, std::memory_order_relaxed);
+  score = static_cast<int16_t>(entry & 0xffff);
+  return true;
+}
+
+void EvalCache::store(uint64_t key, int score) {
+  if (score < INT16_MIN || score > INT16_MAX) return;
+  uint64_t entry = (key & keyMask) | static_cast<uint16_t>(score);
+  entries[key & mask].store(entry, std::memory_order_relaxed);
+}
+
+std::size_t EvalCache::numEntries() const {
+  return mask + 1;
+}
+
+uint64_t EvalCache::numProbes() const {
+  return probes;
+}
+
+uint64_t EvalCache::numHits() const {
+  return hits;
+}
+
+double EvalCache::hitRate() const {
+  uint64_t probed = probes;
+  return probed ? static_cast<double>(hits) / probed : 0;
+}
@@ -0,0 +1,41 @@
+#ifndef EVAL_CACHE_H
+#define EVAL_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// fixed-size cache of static evaluations keyed by Board::getHash(), see
+// Evaluator
+// transpositions and the repeated iterations of iterative deepening evaluate
+// the same positions over and over, this answers all but the first
+// lossy: an entry is overwritten by any other position mapping to it
+// probe and store may be called from several threads at once without locking:
+// an entry is a single word holding the score and the high 48 bits of the
+// key, so it can't be torn
+class EvalCache {
+  std::unique_ptr<std::atomic<uint64_t>[]> entries;
+  // number of entries - 1, the number of entries is a power of two
+  uint64_t mask;
+  std::atomic<uint64_t> probes, hits;
+public:
+  // size is rounded down to a power of two number of entries
+  explicit EvalCache(std::size_t megabytes = 2);
+  void resize(std::size_t megabytes);
+  // forgets all entries and statistics
+  // NOTE: resize and clear must not run during a search
+  void clear();
+  // returns whether the position with the given hash was found, setting
+  // score
+  bool probe(uint64_t key, int &score);
+  // scores that don't fit in 16 bits are not stored
+  void store(uint64_t key, int score);
+  std::size_t numEntries() const;
+  uint64_t numProbes() const;
+  uint64_t numHits() const;
+  // fraction of probes that found their position, 0 if nothing was probed
+  double hitRate() const;
+};
+
+#endif
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "piece_values.h"
+#include "score.h"
+
+#include "evaluator.h"
+
+namespace {
+
+// penalties for each pawn on a column beyond the first, and for each pawn
+// with no pawns of its colour on the columns next to it
+const int doubledPawn[2] = { -10, -20 };
+const int isolatedPawn[2] = { -10, -15 };
+// bonus for a pawn no enemy pawn can stop, by row counted from its colour's
+// side, on top of its piece-square bonus
+const int passedPawn[2][8] = {
+  { 0, 5, 10, 15, 25, 40, 60, 0 },
+  { 0, 10, 15, 25, 45, 75, 115, 0 },
+};
+// penalties for each of the three columns around the king with no pawn of
+// its colour right in front of the king, or two rows in front, and for each
+// with no pawn of its colour at all
+const int missingShield = -25;
+const int farShield = -10;
+const int openFile = -15;
+// bonus for each square a piece can move to, by piece type
+const int mobility[2][6] = {
+  // pawn, rook, knight, bishop, queen, king
+  { 0, 2, 4, 5, 1, 0 },
+  { 0, 4, 4, 5, 2, 0 },
+};
+// bonus for attacking a piece worth more than the attacker, or one that is
+// not defended
+const int threatByLesser[2] = { 25, 15 };
+const int threatOnHanging[2] = { 15, 10 };
+
+// the row counted from colour's side of the board
+int relativeRow(Colour colour, int row) {
+  return colour == WHITE ? row : 7 - row;
+}
+
+bool hasPiece(const Board &board, int row, int col, Piece piece) {
+  if (row < 0 || row > 7 || col < 0 || col > 7) return false;
+  const Piece *p = board.at(row, col);
+  return p && p->colour == piece.colour && p->type == piece.type;
+}
+
+}
+
+Evaluator::Evaluator(std::shared_ptr<const Network> network, EvalCache *cache,
+    std::size_t pawnTableEntries)
+  : net{ std::move(network) }
+  , cache{ cache }
+  , pawns(pawnTableEntries)
+{}
+
+const PawnTable::Entry &Evaluator::pawnStructure(const Board &board) {
+  bool found;
+  PawnTable::Entry &entry = pawns.probe(board.getPawnHash(), found);
+  if (found) return entry;
+
+  // rows of each colour's pawns on each column
+  std::vector<int> rows[2][8];
+  for (int row = 0; row < 8; ++row) {
+    for (int col = 0; col < 8; ++col) {
+      const Piece *piece = board.at(row, col);
+      if (piece && piece->type == PAWN) rows[piece->colour][col].push_back(row);
+    }
+  }
+  int score[2] = { 0, 0 };
+  for (Colour colour : { WHITE, BLACK }) {
+    int sign = colour == WHITE ? 1 : -1;
+    entry.files[colour] = 0;
+    for (int col = 0; col < 8; ++col) {
+      if (rows[colour][col].empty()) continue;
+      entry.files[colour] |= 1 << col;
+      int numPawns = rows[colour][col].size();
+      bool isolated = (col == 0 || rows[colour][col - 1].empty())
+        && (col == 7 || rows[colour][col + 1].empty());
+      for (int phase : { MIDDLEGAME, ENDGAME }) {
+        score[phase] += sign * (numPawns - 1) * doubledPawn[phase];
+        if (isolated) score[phase] += sign * numPawns * isolatedPawn[phase];
+      }
+      for (int row : rows[colour][col]) {
+        // passed if no enemy pawn is ahead of it on its column or the ones
+        // next to it
+        bool passed = true;
+        for (int c = std::max(0, col - 1); c <= std::min(7, col + 1) && passed; ++c) {
+          for (int enemyRow : rows[!colour][c]) {
+            if (relativeRow(colour, enemyRow) > relativeRow(colour, row)) passed = false;
+          }
+        }
+        if (!passed) continue;
+        for (int phase : { MIDDLEGAME, ENDGAME }) {
+          score[phase] += sign * passedPawn[phase][relativeRow(colour, row)];
+        }
+      }
+    }
+  }
+  entry.key = board.getPawnHash();
+  entry.score[MIDDLEGAME] = score[MIDDLEGAME];
+  entry.score[ENDGAME] = score[ENDGAME];
+  return entry;
+}
+
+int Evaluator::kingSafety(const Board &board, Colour colour, const PawnTable::Entry &structure) {
+  const Piece king{ colour, KING };
+  for (int row = 0; row < 8; ++row) {
+    for (int col = 0; col < 8; ++col) {
+      if (!hasPiece(board, row, col, king)) continue;
+      const Piece pawn{ colour, PAWN };
+      int forward = colour == WHITE ? 1 : -1;
+      int points = 0;
+      for (int c = std::max(0, col - 1); c <= std::min(7, col + 1); ++c) {
+        if (hasPiece(board, row + forward, c, pawn)) continue;
+        points += hasPiece(board, row + 2 * forward, c, pawn) ? farShield : missingShield;
+        if (!(structure.files[colour] & 1 << c)) points += openFile;
+      }
+      return points;
+    }
+  }
+  return 0;
+}
+
+void Evaluator::activity(const Board &board, int score[2]) {
+  for (int row = 0; row < 8; ++row) {
+    for (int col = 0; col < 8; ++col) {
+      const Piece *piece = board.at(row, col);
+      if (!piece) continue;
+      int sign = piece->colour == WHITE ? 1 : -1;
+      const std::vector<Coord> &destinations = board.destinations(Coord(row, col));
+      for (int phase : { MIDDLEGAME, ENDGAME }) {
+        score[phase] += sign * static_cast<int>(destinations.size()) * mobility[phase][piece->type];
+      }
+      for (Coord to : destinations) {
+        const Piece *target = board.at(to.row, to.col);
+        // a pawn's moves forward can't capture, and the king is never
+        // captured
+        if (!target || target->colour == piece->colour || target->type == KING) continue;
+        if (pieceValue(target->type) > pieceValue(piece->type)) {
+          for (int phase : { MIDDLEGAME, ENDGAME }) score[phase] += sign * threatByLesser[phase];
+        } else if (board.attackers(to, target->colour).empty()) {
+          for (int phase : { MIDDLEGAME, ENDGAME }) score[phase] += sign * threatOnHanging[phase];
+        }
+      }
+    }
+  }
+}
+
+int Evaluator::evaluate(const Board &board) {
+  switch (board.getState()) {
+  case Board::NORMAL:
+  case Board::CHECK:
+    break;
+  case Board::CHECKMATE:
+    // phasing player gets checkmated, the search adds the distance to the
+    // root (see matedIn)
+    return -mateScore;
+  case Board::STALEMATE:
+  case Board::REPETITION:
+  case Board::FIFTY_MOVES:
+    return 0;
+  case Board::RESIGNED:
+    // if the enemy resigns (they won't, but theoretically) phasing player
+    // gets infinite points
+    return mateScore;
+  }
+
+  int points;
+  if (cache && cache->probe(board.getHash(), points)) return points;
+  points = staticEvaluation(board);
+  if (cache) cache->store(board.getHash(), points);
+  return points;
+}
+
+int Evaluator::staticEvaluation(const Board &board) {
+  if (net) {
+    const Accumulator *accumulator = board.getAccumulator();
+    if (accumulator && board.getNetwork() == net.get()) {
+      return net->evaluate(*accumulator, board.getTurn());
+    }
+    return net->evaluate(board);
+  }
+
+  const PawnTable::Entry &structure = pawnStructure(board);
+  int score[2] = { structure.score[MIDDLEGAME], structure.score[ENDGAME] };
+  activity(board, score);
+  int middlegame = score[MIDDLEGAME], endgame = score[ENDGAME];
+  for (Colour colour : { WHITE, BLACK }) {
+    int sign = colour == WHITE ? 1 : -1;
+    middlegame += sign * (board.getPieceSquare(colour, MIDDLEGAME)
+      + kingSafety(board, colour, structure));
+    endgame += sign * board.getPieceSquare(colour, ENDGAME);
+  }
+  // promotions can take the phase past the start
+  int phase = std::min(board.getPhase(), maxPhase);
+  int points = board.getMaterial(WHITE) - board.getMaterial(BLACK)
+    + (middlegame * phase + endgame * (maxPhase - phase)) / maxPhase;
+  return board.getTurn() == WHITE ? points : -points;
+}
+
+const std::shared_ptr<const Network> &Evaluator::network() const {
+  return net;
+}
+
+const PawnTable &Evaluator::pawnTable() const {
+  return pawns;
+}
@@ -0,0 +1,52 @@
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include <cstddef>
+#include <memory>
+
+#include "board.h"
+#include "colour.h"
+#include "eval_cache.h"
+#include "nnue.h"
+#include "pawn_table.h"
+
+// static evaluation of positions for the engine players
+// the score is material, piece-square bonuses, pawn structure, king safety,
+// mobility and threats, each with a middlegame and an endgame value blended by the phase of
+// the position (see phaseWeight)
+// with a network, the network's score is used instead (see Network)
+// pawn structure is cached in a pawn table, so an evaluator must only be used
+// by one thread at a time
+// with a cache, positions found there are not evaluated again
+class Evaluator {
+  std::shared_ptr<const Network> net;
+  // not owned, may be shared with other evaluators
+  EvalCache *cache;
+  PawnTable pawns;
+  // doubled, isolated and passed pawns of board, from the pawn table or
+  // computed and stored there
+  const PawnTable::Entry &pawnStructure(const Board &board);
+  // middlegame penalty (negative) for the pawns missing in front of
+  // colour's king
+  static int kingSafety(const Board &board, Colour colour, const PawnTable::Entry &structure);
+  // adds white's mobility and threats minus black's to score (indexed by
+  // GamePhase), read from the moves the board keeps (see
+  // Board::destinations)
+  static void activity(const Board &board, int score[2]);
+  // evaluate for positions where the game goes on, without the cache
+  int staticEvaluation(const Board &board);
+public:
+  // cache may be null, and must outlive the evaluator
+  explicit Evaluator(std::shared_ptr<const Network> network = nullptr,
+    EvalCache *cache = nullptr, std::size_t pawnTableEntries = 1 << 14);
+  // points (centipawns) from the perspective of the player whose turn it is,
+  // -mateScore if checkmated (see score.h)
+  // boards that keep the network's accumulator (see Board::setNetwork) are
+  // evaluated incrementally, others from scratch
+  int evaluate(const Board &board);
+  // null if there is none
+  const std::shared_ptr<const Network> &network() const;
+  const PawnTable &pawnTable() const;
+};
+
+#endif
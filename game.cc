@@ -17,61 +17,80 @@ public:
   }
 };
 
-Game::Game(Board board, std::unique_ptr<Player> white, std::unique_ptr<Player> black, std::vector<std::unique_ptr<ChessDisplay>> displays)
+Game::Game(Board board, std::unique_ptr<Player> white, std::unique_ptr<Player> black, std::vector<std::unique_ptr<ChessDisplay>> displays, std::ostream &out)
   : board{ std::move(board) }
   , white{ std::move(white) }
   , black{ std::move(black) }
   , displays{ std::move(displays) }
+  , out{ out }
 {}
 
 Game::Outcome Game::run() {
+  Outcome outcome = play();
+  white->reportGame(out, WHITE);
+  black->reportGame(out, BLACK);
+  return outcome;
+}
+
+Game::Outcome Game::play() {
   while (true) {
     for (std::unique_ptr<ChessDisplay> &display : displays) {
       display->display(board);
     }
     Colour turn = board.getTurn();
+    if (board.gameOver()) {
+      white->stopPondering();
+      black->stopPondering();
+    }
     switch (board.getState()) {
     case Board::NORMAL:
       break;
     case Board::CHECK:
       if (turn == WHITE) {
-        std::cout << "White is in check." << std::endl;
+        out << "White is in check." << std::endl;
       } else { // turn == BLACK
-        std::cout << "Black is in check." << std::endl;
+        out << "Black is in check." << std::endl;
       }
       break;
     case Board::CHECKMATE:
       if (turn == WHITE) {
-        std::cout << "Checkmate! Black wins!" << std::endl;
+        out << "Checkmate! Black wins!" << std::endl;
         return CHECKMATE_BLACK_WINS;
       } else { // turn == BLACK
-        std::cout << "Checkmate! White wins!" << std::endl;
+        out << "Checkmate! White wins!" << std::endl;
         return CHECKMATE_WHITE_WINS;
       }
       break;
     case Board::STALEMATE:
-      std::cout << "Stalemate!" << std::endl;
+      out << "Stalemate!" << std::endl;
       return STALEMATE;
       break;
     case Board::RESIGNED:
       if (turn == WHITE) {
-        std::cout << "White wins!" << std::endl;
+        out << "White wins!" << std::endl;
         return BLACK_RESIGNED;
       } else { // turn == BLACK
-        std::cout << "Black wins!" << std::endl;
+        out << "Black wins!" << std::endl;
         return WHITE_RESIGNED;
       }
       break;
+    case Board::REPETITION:
+      out << "Draw by repetition!" << std::endl;
+      return DRAW;
+      break;
+    case Board::FIFTY_MOVES:
+      out << "Draw by the fifty-move rule!" << std::endl;
+      return DRAW;
+      break;
     }
-    std::unique_ptr<Action> action;
-    if (turn == WHITE) {
-      action = white->getAction(board);
-    } else { // turn == BLACK
-      action = black->getAction(board);
-    }
+    Player &player = turn == WHITE ? *white : *black;
+    std::unique_ptr<Action> action = player.getAction(board);
     {
       ActionPerformer performer(board);
       action->accept(performer);
     }
+    player.reportMove(out, turn);
+    // let the player think while the opponent does
+    if (!board.gameOver()) player.startPondering(board);
   }
 }
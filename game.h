@@ -1,6 +1,7 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include <iostream>
 #include <memory>
 #include <vector>
 
@@ -16,14 +17,20 @@ public:
     STALEMATE,
     BLACK_RESIGNED,
     WHITE_RESIGNED,
+    // by repetition or the fifty-move rule
+    DRAW,
   };
 private:
   Board board;
   std::unique_ptr<Player> white;
   std::unique_ptr<Player> black;
   std::vector<std::unique_ptr<ChessDisplay>> displays;
+  std::ostream &out;
+  Outcome play();
 public:
-  Game(Board board, std::unique_ptr<Player> white, std::unique_ptr<Player> black, std::vector<std::unique_ptr<ChessDisplay>> displays);
+  Game(Board board, std::unique_ptr<Player> white, std::unique_ptr<Player> black, std::vector<std::unique_ptr<ChessDisplay>> displays, std::ostream &out = std::cout);
+  // plays until the game ends, then lets the players report on it (see
+  // Player::reportGame)
   Outcome run();
 };
 
@@ -9,7 +9,9 @@
 
 #include "human_player.h"
 
-HumanPlayer::HumanPlayer() {}
+HumanPlayer::HumanPlayer(std::istream &in, std::ostream &out)
+  : in{ in }, out{ out }
+{}
 
 std::istream &operator>>(std::istream &in, PieceType &type) {
   char c;
@@ -44,7 +46,8 @@ std::unique_ptr<Action> HumanPlayer::getAction(const Board &board) {
   std::unique_ptr<Action> action;
   std::string line;
   do {
-    getline(std::cin, line);
+    // out of input, nobody is left to make a move for this player
+    if (!getline(in, line)) return std::make_unique<Resign>();
     std::istringstream iss(std::move(line));
     std::string cmd;
     iss >> cmd;
@@ -58,7 +61,7 @@ std::unique_ptr<Action> HumanPlayer::getAction(const Board &board) {
           if (board.isLegalMove(move)) {
             action = std::make_unique<Move>(from, to, promoteTo);
           } else {
-            std::cout << "Illegal move." << std::endl;
+            out << "Illegal move." << std::endl;
           }
         }
       } break;
@@ -66,14 +69,14 @@ std::unique_ptr<Action> HumanPlayer::getAction(const Board &board) {
         if (board.hasPriorMove()) {
           action = std::make_unique<Undo>();
         } else {
-          std::cout << "No prior move to undo." << std::endl;
+          out << "No prior move to undo." << std::endl;
         }
       } break;
       case 'r': {
         action = std::make_unique<Resign>();
       } break;
       default: {
-        std::cout << "Unrecognized command." << std::endl;
+        out << "Unrecognized command." << std::endl;
       } break;
     }
   } while (!action);
@@ -1,13 +1,17 @@
 #ifndef HUMAN_PLAYER_H
 #define HUMAN_PLAYER_H
 
+#include <iostream>
+
 #include "player.h"
 
 class Board;
 
 class HumanPlayer : public Player {
+  std::istream &in;
+  std::ostream &out;
 public:
-  HumanPlayer();
+  HumanPlayer(std::istream &in = std::cin, std::ostream &out = std::cout);
   std::unique_ptr<Action> getAction(const Board &board) override;
 };
 
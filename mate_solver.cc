@@ -0,0 +1,171 @@
+#include <algorithm>
+
+#include "board.h"
+
+#include "mate_solver.h"
+
+namespace {
+
+// a disproven node, or a threshold that is never reached
+const uint32_t infinity = 1u << 30;
+
+uint32_t saturatedAdd(uint32_t a, uint32_t b) {
+  return std::min(infinity, a + b);
+}
+
+}
+
+MateSolver::MateSolver(std::size_t maxEntries)
+  : maxEntries{ std::max<std::size_t>(1, maxEntries) }
+  , nodes{ 0 }
+  , maxNodes{ 0 }
+{}
+
+uint64_t MateSolver::key(const Board &board, int plies) {
+  uint64_t result = board.getHash() ^ (static_cast<uint64_t>(plies) * 0x9e3779b97f4a7c15ull);
+  // the clock can't reach the fifty-move rule otherwise, and leaving it out
+  // lets positions reached by different captures and pawn moves share entries
+  int clock = board.getHalfmoveClock();
+  if (clock + plies >= 100) result ^= static_cast<uint64_t>(clock + 1) * 0xc2b2ae3d27d4eb4full;
+  return result;
+}
+
+MateSolver::Numbers MateSolver::evaluate(const Board &board, int plies, bool &dependent) const {
+  // the attacker moves when an odd number of plies remain
+  bool attackerToMove = plies % 2 == 1;
+  // the player to move lost
+  if (board.getState() == Board::CHECKMATE) return Numbers{ infinity, 0 };
+  if (board.getState() == Board::REPETITION) dependent = true;
+  // any other end of the game, or of the plies, is the defender's escape
+  if (board.gameOver() || plies == 0) {
+    return attackerToMove ? Numbers{ infinity, 0 } : Numbers{ 0, infinity };
+  }
+  auto it = table.find(key(board, plies));
+  return it == table.end() ? Numbers{ 1, 1 } : it->second;
+}
+
+void MateSolver::store(const Board &board, int plies, Numbers numbers) {
+  if (table.size() >= maxEntries) table.clear();
+  table[key(board, plies)] = numbers;
+}
+
+bool MateSolver::outOfNodes() const {
+  return maxNodes && nodes >= maxNodes;
+}
+
+MateSolver::Numbers MateSolver::search(Board &board, int plies, uint32_t phiThreshold,
+    uint32_t deltaThreshold, bool &dependent) {
+  ++nodes;
+  bool attackerToMove = plies % 2 == 1;
+  std::vector<Move> moves = board.legalMoves();
+  // the children's numbers are kept here rather than read back from the
+  // table, since reading them means making every move again
+  // a child starts with a guess of 1 and 1, and only gets made once it is
+  // picked to be searched: a defence that escapes usually settles a node
+  // before its other defences are tried
+  std::vector<Numbers> children(moves.size(), Numbers{ 1, 1 });
+  std::vector<bool> expanded(moves.size(), false), childDependent(moves.size(), false);
+  // with one ply left only a check can mate, and testing for check is much
+  // cheaper than making the move
+  if (plies == 1) {
+    for (size_t i = 0; i < moves.size(); ++i) {
+      if (board.givesCheck(moves[i])) continue;
+      children[i] = Numbers{ 0, infinity };
+      expanded[i] = true;
+    }
+  }
+
+  Numbers numbers;
+  while (true) {
+    // the player to move wins if any child is lost for the opponent, and
+    // loses only if every child is won for the opponent
+    uint32_t minDelta = infinity, secondDelta = infinity, sumPhi = 0;
+    size_t best = 0;
+    for (size_t i = 0; i < children.size(); ++i) {
+      sumPhi = saturatedAdd(sumPhi, children[i].phi);
+      if (children[i].delta < minDelta) {
+        secondDelta = minDelta;
+        minDelta = children[i].delta;
+        best = i;
+      } else if (children[i].delta < secondDelta) {
+        secondDelta = children[i].delta;
+      }
+    }
+    numbers = Numbers{ minDelta, sumPhi };
+    if (numbers.phi >= phiThreshold || numbers.delta >= deltaThreshold || outOfNodes()) break;
+
+    // search the most promising child until it stops being the most
+    // promising, or this node reaches a threshold
+    uint32_t childPhiThreshold = deltaThreshold - sumPhi + children[best].phi;
+    uint32_t childDeltaThreshold = std::min(phiThreshold, saturatedAdd(secondDelta, 1));
+    bool childIsDependent = false;
+    board.move(moves[best]);
+    if (!expanded[best]) {
+      // the game being over or the table may know better than the guess
+      expanded[best] = true;
+      Numbers known = evaluate(board, plies - 1, childIsDependent);
+      if (known.phi != children[best].phi || known.delta != children[best].delta) {
+        children[best] = known;
+        childDependent[best] = childIsDependent;
+        board.undo();
+        continue;
+      }
+    }
+    children[best] = search(board, plies - 1, childPhiThreshold, childDeltaThreshold, childIsDependent);
+    board.undo();
+    childDependent[best] = childIsDependent;
+  }
+  // a mate is stored whatever the path: a mate ignoring repetitions is a mate
+  // without repeating a position, by always playing the fastest mate
+  // anything else may rest on a repetition of this path
+  bool mate = attackerToMove ? numbers.phi == 0 : numbers.delta == 0;
+  if (!mate) dependent = std::find(childDependent.begin(), childDependent.end(), true) != childDependent.end();
+  if (!dependent && !outOfNodes()) store(board, plies, numbers);
+  return numbers;
+}
+
+MateSolver::Result MateSolver::solve(const Board &board, int moves, uint64_t maxNodes) {
+  this->maxNodes = maxNodes;
+  nodes = 0;
+  line.clear();
+  if (board.gameOver() || moves <= 0) return NO_MATE;
+
+  int plies = 2 * moves - 1;
+  Board copy = board;
+  bool dependent = false;
+  Numbers numbers = search(copy, plies, infinity, infinity, dependent);
+  if (numbers.delta == 0) return NO_MATE;
+  if (numbers.phi != 0) return UNKNOWN;
+
+  // follow proven moves: the attacker's mating moves, and any defence since
+  // they all get mated
+  for (; copy.getState() != Board::CHECKMATE; --plies) {
+    bool found = false;
+    for (const Move &move : copy.legalMoves()) {
+      copy.move(move);
+      Numbers child = evaluate(copy, plies - 1, dependent);
+      bool proven = plies % 2 == 1 ? child.delta == 0 : child.phi == 0;
+      if (proven) {
+        line.push_back(move);
+        found = true;
+        break;
+      }
+      copy.undo();
+    }
+    // the table was cleared under the proof, the line is cut short
+    if (!found) break;
+  }
+  return MATE;
+}
+
+const std::vector<Move> &MateSolver::mateLine() const {
+  return line;
+}
+
+uint64_t MateSolver::numNodes() const {
+  return nodes;
+}
+
+void MateSolver::clear() {
+  table.clear();
+}
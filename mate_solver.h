@@ -0,0 +1,75 @@
+#ifndef MATE_SOLVER_H
+#define MATE_SOLVER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "move.h"
+
+class Board;
+
+// answers whether the player to move (the attacker) can force checkmate
+// within a number of moves, with depth-first proof-number search (df-pn)
+// proof-number search always expands the move closest to being proven (the
+// one with the fewest defences left to refute) or disproven, so forcing
+// lines get searched deep long before alpha-beta would reach them, and it
+// needs no evaluation
+// a draw by repetition counts as an escape for the defender, but only on the
+// path it happens on: a mate never needs to repeat a position after the
+// root, since the attacker can always play the fastest mate
+class MateSolver {
+public:
+  enum Result {
+    MATE,
+    NO_MATE,
+    // the node budget ran out first
+    UNKNOWN,
+  };
+private:
+  // proof numbers from the perspective of the player to move at a node:
+  // phi is how many leaves must still be proven for the player to move to
+  // win (mate, or escape if defending), delta how many for them to lose
+  // 0 means proven, see infinity in mate_solver.cc for disproven
+  struct Numbers {
+    uint32_t phi, delta;
+  };
+  // keyed by position and remaining plies, since a mate in n moves is not a
+  // mate in n - 1, and by the halfmove clock when the fifty-move rule could
+  // end the game within the remaining plies
+  // draws by repetition depend on the path to a position rather than on the
+  // position (the graph history interaction problem), so numbers that
+  // depend on one are never stored, see search
+  std::unordered_map<uint64_t, Numbers> table;
+  std::size_t maxEntries;
+  uint64_t nodes, maxNodes;
+  std::vector<Move> line;
+  static uint64_t key(const Board &board, int plies);
+  // numbers of the position reached with plies remaining, from the table if
+  // it isn't over
+  // sets dependent if they hold only on the path that reached the position
+  Numbers evaluate(const Board &board, int plies, bool &dependent) const;
+  void store(const Board &board, int plies, Numbers numbers);
+  bool outOfNodes() const;
+  // expands the position until its numbers reach a threshold, then returns
+  // them, storing them unless they depend on the path (see evaluate)
+  // assumes the position isn't over
+  Numbers search(Board &board, int plies, uint32_t phiThreshold, uint32_t deltaThreshold,
+    bool &dependent);
+public:
+  // the table is cleared whenever it reaches maxEntries
+  explicit MateSolver(std::size_t maxEntries = 1 << 20);
+  // whether the player to move can mate in at most moves of their own moves,
+  // searching at most maxNodes positions (0 means no limit)
+  // keeps the table of earlier calls, results in it stay valid
+  Result solve(const Board &board, int moves, uint64_t maxNodes = 0);
+  // after MATE: a mating line, the attacker's moves alternating with
+  // defences, ending in checkmate
+  const std::vector<Move> &mateLine() const;
+  // expanded in the last solve
+  uint64_t numNodes() const;
+  void clear();
+};
+
+#endif
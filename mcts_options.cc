@@ -0,0 +1,10 @@
+#include "mcts_options.h"
+
+MctsOptions::MctsOptions()
+  : selection{ PUCT }
+  , exploration{ 1.5 }
+  , playout{ CAPTURES }
+  , playoutPlies{ 8 }
+  , threads{ 1 }
+  , maxTreeNodes{ 1 << 18 }
+{}
@@ -0,0 +1,40 @@
+#ifndef MCTS_OPTIONS_H
+#define MCTS_OPTIONS_H
+
+#include <cstddef>
+
+// tuning switches of ComputerPlayer5's Monte Carlo tree search, the budget
+// per move is in SearchLimits
+struct MctsOptions {
+  // how a node picks the child to descend into
+  enum Selection {
+    // upper confidence bound: average result plus a bonus shrinking with
+    // the child's share of the visits, every child is tried once first
+    UCT,
+    // AlphaZero's predictor variant: the bonus is weighted by a prior
+    // probability of the move (captures that win material rank higher), so
+    // unlikely moves may never be tried
+    PUCT,
+  };
+  // how the moves of a playout are picked
+  enum Playout {
+    RANDOM,
+    // usually the capture that wins the most material according to static
+    // exchange evaluation, a random move otherwise
+    CAPTURES,
+  };
+  Selection selection;
+  // weight of the exploration bonus against the average result
+  double exploration;
+  Playout playout;
+  // moves played in a playout before the position is evaluated (see
+  // Evaluator::evaluate), playouts also stop when the game ends
+  int playoutPlies;
+  // number of threads growing the tree in parallel, at least 1
+  int threads;
+  // size of the node pool, the search stops when it is full
+  std::size_t maxTreeNodes;
+  MctsOptions();
+};
+
+#endif
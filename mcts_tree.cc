@@ -0,0 +1,51 @@
+#include <algorithm>
+
+#include "mcts_tree.h"
+
+MctsTree::MctsTree(std::size_t capacity) : capacity{ capacity }, used{ 0 } {}
+
+void MctsTree::resize(std::size_t capacity) {
+  if (capacity == this->capacity) return;
+  this->capacity = capacity;
+  nodes.reset();
+}
+
+void MctsTree::reset() {
+  capacity = std::max<std::size_t>(1, capacity);
+  if (!nodes) nodes = std::make_unique<MctsNode[]>(capacity);
+  used = 0;
+  allocate(1);
+}
+
+int64_t MctsTree::allocate(std::size_t count) {
+  std::size_t first = used.fetch_add(count);
+  if (first + count > capacity) {
+    // keep used from wrapping around after many failed allocations
+    used = capacity;
+    return -1;
+  }
+  // nodes are reused from earlier trees
+  for (std::size_t i = first; i < first + count; ++i) {
+    MctsNode &node = nodes[i];
+    node.prior = 0;
+    node.firstChild = 0;
+    node.numChildren = 0;
+    node.state.store(MctsNode::LEAF, std::memory_order_relaxed);
+    node.visits.store(0, std::memory_order_relaxed);
+    node.virtualLoss.store(0, std::memory_order_relaxed);
+    node.valueSum.store(0, std::memory_order_relaxed);
+  }
+  return first;
+}
+
+MctsNode &MctsTree::operator[](uint32_t index) {
+  return nodes[index];
+}
+
+const MctsNode &MctsTree::operator[](uint32_t index) const {
+  return nodes[index];
+}
+
+std::size_t MctsTree::size() const {
+  return std::min(capacity, used.load());
+}
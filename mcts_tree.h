@@ -0,0 +1,66 @@
+#ifndef MCTS_TREE_H
+#define MCTS_TREE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "move.h"
+
+// a position in a Monte Carlo search tree, see ComputerPlayer5
+// the counters may be updated by several threads at once
+struct MctsNode {
+  enum State : uint8_t {
+    // children not generated yet
+    LEAF,
+    // a thread is generating the children
+    EXPANDING,
+    // firstChild and numChildren are set, no children means the game is over
+    EXPANDED,
+  };
+  // the move leading here from the parent, meaningless at the root
+  Move move{ Coord(0, 0), Coord(0, 0) };
+  // chance the move is the best one, guessed when the parent is expanded
+  float prior = 0;
+  // index of the first child in the tree, the children are contiguous
+  // only read after seeing state EXPANDED
+  uint32_t firstChild = 0;
+  uint32_t numChildren = 0;
+  std::atomic<uint8_t> state{ LEAF };
+  // completed playouts through this node
+  std::atomic<uint32_t> visits{ 0 };
+  // playouts through this node still running, counted as lost while they
+  // run so other threads explore elsewhere (virtual loss)
+  std::atomic<uint32_t> virtualLoss{ 0 };
+  // sum of the playout results for the player who made move (1 win, 0.5
+  // draw, 0 loss), in fixed point, see MctsTree::valueScale
+  std::atomic<uint64_t> valueSum{ 0 };
+};
+
+// a pool of nodes allocated once, so growing the tree never calls the memory
+// allocator and every node is reached by index
+// allocate may be called from several threads at once
+class MctsTree {
+  std::unique_ptr<MctsNode[]> nodes;
+  std::size_t capacity;
+  std::atomic<std::size_t> used;
+public:
+  // node results are stored as multiples of 1 / valueScale
+  static const uint64_t valueScale = 1 << 16;
+  // the pool is allocated on the first reset with a capacity set since
+  explicit MctsTree(std::size_t capacity);
+  // changes the capacity, reallocating on the next reset
+  void resize(std::size_t capacity);
+  // discards the tree and allocates a new root, index 0
+  // NOTE: must not run while other threads use the tree
+  void reset();
+  // returns the index of the first of count fresh contiguous nodes, or -1 if
+  // the pool doesn't have that many left
+  int64_t allocate(std::size_t count);
+  MctsNode &operator[](uint32_t index);
+  const MctsNode &operator[](uint32_t index) const;
+  std::size_t size() const;
+};
+
+#endif
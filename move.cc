@@ -17,3 +17,7 @@ bool Move::operator<(const Move &other) const {
   if (other.to < to) return false;
   return promoteTo < other.promoteTo;
 }
+
+bool Move::operator==(const Move &other) const {
+  return from == other.from && to == other.to && promoteTo == other.promoteTo;
+}
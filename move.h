@@ -12,6 +12,7 @@ struct Move : Action {
   void accept(ActionVisitor &visitor) override;
   // this is so we can put moves into std::set
   bool operator<(const Move &) const;
+  bool operator==(const Move &) const;
 };
 
 
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <utility>
+
+#include "board.h"
+#include "piece_values.h"
+
+#include "move_orderer.h"
+
+MoveOrderer::MoveOrderer() : killers(2 * maxPly, Move(Coord(0, 0), Coord(0, 0))) {
+  clear();
+}
+
+int MoveOrderer::value(PieceType type) {
+  // only ever an attacker, make it the least attractive one
+  if (type == KING) return pieceValue(QUEEN) + pieceValue(PAWN);
+  return pieceValue(type);
+}
+
+bool MoveOrderer::isCapture(const Board &board, const Move &move) {
+  return board.isCapture(move);
+}
+
+int MoveOrderer::staticExchange(const Board &board, const Move &move) {
+  const Piece *mover = board.at(move.from.row, move.from.col);
+  const Piece *victim = board.at(move.to.row, move.to.col);
+  // en passant captures a pawn
+  int firstGain = victim ? value(victim->type)
+    : (mover->type == PAWN && move.from.col != move.to.col ? value(PAWN) : 0);
+  // the piece standing on the square after each capture
+  int onSquare = value(mover->type);
+  if (move.promoteTo != PAWN) {
+    firstGain += value(move.promoteTo) - value(PAWN);
+    onSquare = value(move.promoteTo);
+  }
+
+  // attackers of each side sorted least valuable first
+  std::array<std::vector<int>, 2> values;
+  for (int colour = BLACK; colour <= WHITE; ++colour) {
+    for (Coord coord : board.attackers(move.to, static_cast<Colour>(colour))) {
+      if (coord == move.from) continue;
+      values[colour].push_back(value(board.at(coord.row, coord.col)->type));
+    }
+    std::sort(values[colour].begin(), values[colour].end());
+  }
+
+  // gains[i] is the material won by the side making the ith capture if the
+  // exchange stopped there
+  std::vector<int> gains{ firstGain };
+  Colour side = !board.getTurn();
+  std::array<size_t, 2> next{ 0, 0 };
+  while (next[side] < values[side].size()) {
+    gains.push_back(onSquare - gains.back());
+    onSquare = values[side][next[side]++];
+    side = !side;
+  }
+  // each side only continues the exchange if it pays off
+  for (size_t i = gains.size() - 1; i > 0; --i) {
+    gains[i - 1] = -std::max(-gains[i - 1], gains[i]);
+  }
+  return gains.front();
+}
+
+int MoveOrderer::captureScore(const Board &board, const Move &move) {
+  const Piece *victim = board.at(move.to.row, move.to.col);
+  // en passant captures a pawn, a plain promotion captures nothing
+  int victimValue = victim ? value(victim->type) : (move.promoteTo == PAWN ? value(PAWN) : 0);
+  int promotionValue = move.promoteTo == PAWN ? 0 : value(move.promoteTo) - value(PAWN);
+  int attackerValue = value(board.at(move.from.row, move.from.col)->type);
+  return 16 * (victimValue + promotionValue) - attackerValue;
+}
+
+const Move &MoveOrderer::killer(int ply, int slot) const {
+  return killers[2 * ply + slot];
+}
+
+int MoveOrderer::historyScore(const Board &board, const Move &move) const {
+  return history[board.getTurn()][move.from.row * 8 + move.from.col][move.to.row * 8 + move.to.col];
+}
+
+int MoveOrderer::score(const Board &board, const Move &move, const Move *hashMove, int ply) const {
+  const int hashScore = 1 << 30, captureBase = 1 << 29, killerScore = 1 << 28;
+  if (hashMove && move == *hashMove) return hashScore;
+  if (isCapture(board, move)) return captureBase + captureScore(board, move);
+  if (ply < maxPly) {
+    if (move == killers[2 * ply]) return killerScore + 1;
+    if (move == killers[2 * ply + 1]) return killerScore;
+  }
+  return historyScore(board, move);
+}
+
+void MoveOrderer::order(const Board &board, std::vector<Move> &moves, const Move *hashMove, int ply) const {
+  std::vector<std::pair<int, size_t>> scores;
+  scores.reserve(moves.size());
+  for (size_t i = 0; i < moves.size(); ++i) {
+    scores.emplace_back(score(board, moves[i], hashMove, ply), i);
+  }
+  std::stable_sort(scores.begin(), scores.end(),
+    [](const std::pair<int, size_t> &a, const std::pair<int, size_t> &b) {
+      return a.first > b.first;
+    });
+  std::vector<Move> ordered;
+  ordered.reserve(moves.size());
+  for (const std::pair<int, size_t> &score : scores) ordered.push_back(moves[score.second]);
+  moves = std::move(ordered);
+}
+
+void MoveOrderer::cutoff(const Board &board, const Move &move, int ply, int depth) {
+  // captures are already searched early
+  if (isCapture(board, move)) return;
+  if (ply < maxPly && !(move == killers[2 * ply])) {
+    killers[2 * ply + 1] = killers[2 * ply];
+    killers[2 * ply] = move;
+  }
+  int &entry = history[board.getTurn()][move.from.row * 8 + move.from.col][move.to.row * 8 + move.to.col];
+  entry += depth * depth;
+  // keep history scores well below the killer scores
+  if (entry >= 1 << 20) {
+    for (auto &colour : history)
+      for (auto &from : colour)
+        for (int &to : from) to /= 2;
+  }
+}
+
+void MoveOrderer::newSearch() {
+  std::fill(killers.begin(), killers.end(), Move(Coord(0, 0), Coord(0, 0)));
+  for (auto &colour : history)
+    for (auto &from : colour)
+      for (int &to : from) to /= 2;
+}
+
+void MoveOrderer::clear() {
+  std::fill(killers.begin(), killers.end(), Move(Coord(0, 0), Coord(0, 0)));
+  for (auto &colour : history)
+    for (auto &from : colour) from.fill(0);
+}
@@ -0,0 +1,57 @@
+#ifndef MOVE_ORDERER_H
+#define MOVE_ORDERER_H
+
+#include <array>
+#include <vector>
+
+#include "move.h"
+
+class Board;
+
+// orders moves so that alpha-beta searches the likely best moves first:
+// the hash move, then captures and promotions by most valuable victim / least
+// valuable attacker, then killer moves (quiet moves that caused a cutoff at
+// the same ply), then quiet moves by how often they caused cutoffs before
+class MoveOrderer {
+public:
+  static const int maxPly = 128;
+private:
+  // two killers per ply, a move with from == to means no killer
+  std::vector<Move> killers;
+  // indexed by [colour][from][to], 0-63 squares
+  std::array<std::array<std::array<int, 64>, 64>, 2> history;
+  int score(const Board &board, const Move &move, const Move *hashMove, int ply) const;
+public:
+  MoveOrderer();
+  // value of a piece in centipawns, see pieceValue, the king (which is only
+  // ever an attacker) counts as more than a queen
+  static int value(PieceType type);
+  // true for captures (including en passant) and promotions
+  static bool isCapture(const Board &board, const Move &move);
+  // material (in centipawns) the side to move wins by playing the capture move
+  // and then exchanging on its destination square, least valuable pieces
+  // first, both sides stopping when further exchanges would lose material
+  // NOTE: ignores pins and pieces attacking through other attackers
+  static int staticExchange(const Board &board, const Move &move);
+  // most valuable victim / least valuable attacker rank of a capture or
+  // promotion, higher first
+  static int captureScore(const Board &board, const Move &move);
+  // the killer moves at ply < maxPly, slot 0 is the most recent one
+  // a move with from == to means no killer
+  const Move &killer(int ply, int slot) const;
+  // how often move caused cutoffs, weighted by depth, for the side to move
+  int historyScore(const Board &board, const Move &move) const;
+  // sorts moves best first, keeping the relative order of equal moves
+  // hashMove may be null
+  void order(const Board &board, std::vector<Move> &moves, const Move *hashMove, int ply) const;
+  // records that move caused a beta cutoff, board must be the position the
+  // move was played from
+  void cutoff(const Board &board, const Move &move, int ply, int depth);
+  // forgets killers, which are tied to plies from the root, and fades the
+  // history, which mostly still holds for the next position of the game
+  // call at the start of every search
+  void newSearch();
+  void clear();
+};
+
+#endif
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <utility>
+
+#include "board.h"
+#include "move_orderer.h"
+
+#include "move_picker.h"
+
+namespace {
+
+// stable so that equally ranked moves keep the board's order
+template<typename Score>
+void sortBy(std::vector<Move> &moves, Score score) {
+  std::vector<std::pair<int, Move>> scored;
+  scored.reserve(moves.size());
+  for (const Move &move : moves) scored.emplace_back(score(move), move);
+  std::stable_sort(scored.begin(), scored.end(),
+    [](const std::pair<int, Move> &a, const std::pair<int, Move> &b) {
+      return a.first > b.first;
+    });
+  for (size_t i = 0; i < moves.size(); ++i) moves[i] = scored[i].second;
+}
+
+}
+
+MovePicker::MovePicker(const Board &board, const MoveOrderer &orderer,
+    const Move *hashMove, int ply, bool capturesOnly)
+  : board(board)
+  , orderer(orderer)
+  , ply{ ply }
+  , capturesOnly{ capturesOnly }
+  , stage{ HASH_MOVE }
+  , index{ 0 }
+{
+  if (hashMove && !capturesOnly && board.isLegalMove(*hashMove)) {
+    this->hashMove = std::make_unique<Move>(*hashMove);
+  }
+}
+
+bool MovePicker::pickedEarlier(const Move &move) const {
+  if (hashMove && move == *hashMove) return true;
+  return stage == QUIETS && std::find(killers.begin(), killers.end(), move) != killers.end();
+}
+
+void MovePicker::generate() {
+  index = 0;
+  switch (stage) {
+  case CAPTURES:
+    captures = board.legalCaptures();
+    sortBy(captures, [this](const Move &move) { return MoveOrderer::captureScore(board, move); });
+    break;
+  case KILLERS:
+    if (ply >= MoveOrderer::maxPly) break;
+    for (int slot = 0; slot < 2; ++slot) {
+      const Move &killer = orderer.killer(ply, slot);
+      // a killer is a quiet move of another position at the same ply, it
+      // may not be legal or quiet here
+      if (killer.from == killer.to || !board.isLegalMove(killer) || board.isCapture(killer)) continue;
+      killers.push_back(killer);
+    }
+    break;
+  case QUIETS:
+    quiets = board.legalQuietMoves();
+    sortBy(quiets, [this](const Move &move) { return orderer.historyScore(board, move); });
+    break;
+  case HASH_MOVE:
+  case DONE:
+    break;
+  }
+}
+
+const Move *MovePicker::next() {
+  while (stage != DONE) {
+    const std::vector<Move> *moves = nullptr;
+    switch (stage) {
+    case HASH_MOVE:
+      if (hashMove && index++ == 0) return hashMove.get();
+      break;
+    case CAPTURES:
+      moves = &captures;
+      break;
+    case KILLERS:
+      moves = &killers;
+      break;
+    case QUIETS:
+      moves = &quiets;
+      break;
+    case DONE:
+      break;
+    }
+    while (moves && index < moves->size()) {
+      const Move &move = (*moves)[index++];
+      if (!pickedEarlier(move)) return &move;
+    }
+    // the stage is used up
+    stage = capturesOnly && stage == CAPTURES ? DONE : static_cast<Stage>(stage + 1);
+    generate();
+  }
+  return nullptr;
+}
+
+MovePicker::Stage MovePicker::currentStage() const {
+  return stage;
+}
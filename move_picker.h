@@ -0,0 +1,57 @@
+#ifndef MOVE_PICKER_H
+#define MOVE_PICKER_H
+
+#include <memory>
+#include <vector>
+
+#include "move.h"
+
+class Board;
+class MoveOrderer;
+
+// hands out the legal moves of a position one at a time in the order of
+// MoveOrderer, in stages: the hash move, captures and promotions, killer
+// moves, then quiet moves
+// each stage is only collected and sorted once the previous one is used up,
+// so a node that cuts off early never looks at the moves it didn't search
+// board must be in the position the picker was made for whenever next is
+// called, moves may be made and undone in between
+class MovePicker {
+public:
+  enum Stage {
+    HASH_MOVE,
+    CAPTURES,
+    KILLERS,
+    QUIETS,
+    DONE,
+  };
+private:
+  const Board &board;
+  const MoveOrderer &orderer;
+  std::unique_ptr<Move> hashMove;
+  int ply;
+  bool capturesOnly;
+  Stage stage;
+  // moves of the current stage and every earlier one, so pointers returned
+  // by next stay valid
+  std::vector<Move> captures, killers, quiets;
+  // index of the next move in the current stage's list
+  size_t index;
+  // whether move was already handed out by an earlier stage
+  bool pickedEarlier(const Move &move) const;
+  // collects the moves of stage
+  void generate();
+public:
+  // hashMove may be null or illegal, in which case it is skipped
+  // with capturesOnly, only captures and promotions are handed out (for
+  // quiescence search), and no hash move
+  MovePicker(const Board &board, const MoveOrderer &orderer, const Move *hashMove,
+    int ply, bool capturesOnly = false);
+  // the next move, or null when there are none left
+  // the move stays valid as long as the picker
+  const Move *next();
+  // stage of the move last returned by next
+  Stage currentStage() const;
+};
+
+#endif
@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include "board.h"
+#include "score.h"
+
+#include "nnue.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NNUE_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const int inputSize = 2 * Accumulator::size;
+const int l1Shift = 6;
+const int outputDivisor = 16;
+
+// the dense layers, see Network
+// clip: out[i] = min(max(in[i], 0), 127) for i < Accumulator::size
+// affine: out[o] = biases[o] + sum of in[i] * weights[o * inputSize + i]
+//   for o < Network::l1Size
+
+void clipScalar(const int16_t *in, uint8_t *out) {
+  for (int i = 0; i < Accumulator::size; ++i) {
+    out[i] = std::min<int16_t>(std::max<int16_t>(in[i], 0), 127);
+  }
+}
+
+void affineScalar(const uint8_t *in, const int8_t *weights, const int32_t *biases, int32_t *out) {
+  for (int o = 0; o < Network::l1Size; ++o) {
+    int32_t sum = biases[o];
+    const int8_t *row = weights + o * inputSize;
+    for (int i = 0; i < inputSize; ++i) sum += in[i] * row[i];
+    out[o] = sum;
+  }
+}
+
+#ifdef NNUE_X86
+
+// clipping before packing keeps the signed saturation of packs from
+// mattering, and the products of maddubs (at most 2 * 127 * 128 in absolute
+// value) from saturating, so these match the scalar versions exactly
+
+__attribute__((target("ssse3")))
+void clipSsse3(const int16_t *in, uint8_t *out) {
+  const __m128i zero = _mm_setzero_si128();
+  for (int i = 0; i < Accumulator::size; i += 16) {
+    __m128i a = _mm_max_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i)), zero);
+    __m128i b = _mm_max_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 8)), zero);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packs_epi16(a, b));
+  }
+}
+
+__attribute__((target("ssse3")))
+void affineSsse3(const uint8_t *in, const int8_t *weights, const int32_t *biases, int32_t *out) {
+  const __m128i ones = _mm_set1_epi16(1);
+  for (int o = 0; o < Network::l1Size; ++o) {
+    const int8_t *row = weights + o * inputSize;
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < inputSize; i += 16) {
+      __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+      __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+      sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(x, w), ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+    out[o] = biases[o] + _mm_cvtsi128_si32(sum);
+  }
+}
+
+__attribute__((target("avx2")))
+void clipAvx2(const int16_t *in, uint8_t *out) {
+  const __m256i zero = _mm256_setzero_si256();
+  for (int i = 0; i < Accumulator::size; i += 32) {
+    __m256i a = _mm256_max_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i)), zero);
+    __m256i b = _mm256_max_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i + 16)), zero);
+    // packs works within 128-bit lanes, put the quarters back in order
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(a, b), 0xd8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), packed);
+  }
+}
+
+__attribute__((target("avx2")))
+void affineAvx2(const uint8_t *in, const int8_t *weights, const int32_t *biases, int32_t *out) {
+  const __m256i ones = _mm256_set1_epi16(1);
+  for (int o = 0; o < Network::l1Size; ++o) {
+    const int8_t *row = weights + o * inputSize;
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < inputSize; i += 32) {
+      __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+      __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + i));
+      sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(x, w), ones));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4e));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xb1));
+    out[o] = biases[o] + _mm_cvtsi128_si32(half);
+  }
+}
+
+#endif
+
+uint64_t readUnsigned(const char *bytes, int size) {
+  uint64_t value = 0;
+  for (int i = size - 1; i >= 0; --i) value = value << 8 | static_cast<uint8_t>(bytes[i]);
+  return value;
+}
+
+template <typename T>
+void readValues(std::istream &in, std::vector<T> &values, std::size_t count) {
+  std::vector<char> bytes(count * sizeof(T));
+  if (!in.read(bytes.data(), bytes.size())) throw std::logic_error("Truncated network file.");
+  values.resize(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    values[i] = static_cast<T>(readUnsigned(bytes.data() + i * sizeof(T), sizeof(T)));
+  }
+}
+
+uint32_t readUint32(std::istream &in) {
+  std::vector<uint32_t> value;
+  readValues(in, value, 1);
+  return value.front();
+}
+
+}
+
+Network::Network() : outputBias{ 0 }, simd{ supportedSimd() } {}
+
+int Network::feature(Colour perspective, Piece piece, Coord coord) {
+  int row = perspective == WHITE ? coord.row : 7 - coord.row;
+  int side = piece.colour == perspective ? 0 : 1;
+  return (side * 6 + piece.type) * 64 + row * 8 + coord.col;
+}
+
+std::unique_ptr<Network> Network::load(std::istream &in) {
+  char magic[4];
+  if (!in.read(magic, 4) || std::string(magic, 4) != "NNUE") {
+    throw std::logic_error("Not a network file.");
+  }
+  uint32_t version = readUint32(in);
+  uint32_t accumulatorSize = readUint32(in);
+  uint32_t outputs = readUint32(in);
+  if (version != 1 || accumulatorSize != Accumulator::size || outputs != l1Size) {
+    throw std::logic_error("Unsupported network architecture.");
+  }
+  std::unique_ptr<Network> network(new Network());
+  readValues(in, network->featureWeights, numFeatures * Accumulator::size);
+  readValues(in, network->featureBiases, Accumulator::size);
+  readValues(in, network->l1Weights, l1Size * inputSize);
+  readValues(in, network->l1Biases, l1Size);
+  readValues(in, network->outputWeights, l1Size);
+  std::vector<int32_t> outputBias;
+  readValues(in, outputBias, 1);
+  network->outputBias = outputBias.front();
+  return network;
+}
+
+std::unique_ptr<Network> Network::load(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) throw std::logic_error("Cannot open network file " + path + ".");
+  return load(file);
+}
+
+Network::Simd Network::supportedSimd() {
+#ifdef NNUE_X86
+  if (__builtin_cpu_supports("avx2")) return AVX2;
+  if (__builtin_cpu_supports("ssse3")) return SSSE3;
+#endif
+  return SCALAR;
+}
+
+Network::Simd Network::getSimd() const {
+  return simd;
+}
+
+void Network::setSimd(Simd simd) {
+  this->simd = std::min(simd, supportedSimd());
+}
+
+void Network::refresh(const Board &board, Accumulator &accumulator) const {
+  for (Colour perspective : { WHITE, BLACK }) {
+    std::copy(featureBiases.begin(), featureBiases.end(), accumulator.values[perspective]);
+  }
+  for (int row = 0; row < 8; ++row) {
+    for (int col = 0; col < 8; ++col) {
+      const Piece *piece = board.at(row, col);
+      if (piece) addPiece(accumulator, *piece, Coord(row, col));
+    }
+  }
+}
+
+void Network::addPiece(Accumulator &accumulator, Piece piece, Coord coord) const {
+  for (Colour perspective : { WHITE, BLACK }) {
+    const int16_t *column = &featureWeights[feature(perspective, piece, coord) * Accumulator::size];
+    int16_t *values = accumulator.values[perspective];
+    for (int i = 0; i < Accumulator::size; ++i) values[i] += column[i];
+  }
+}
+
+void Network::removePiece(Accumulator &accumulator, Piece piece, Coord coord) const {
+  for (Colour perspective : { WHITE, BLACK }) {
+    const int16_t *column = &featureWeights[feature(perspective, piece, coord) * Accumulator::size];
+    int16_t *values = accumulator.values[perspective];
+    for (int i = 0; i < Accumulator::size; ++i) values[i] -= column[i];
+  }
+}
+
+int Network::evaluate(const Accumulator &accumulator, Colour turn) const {
+  void (*clip)(const int16_t *, uint8_t *) = clipScalar;
+  void (*affine)(const uint8_t *, const int8_t *, const int32_t *, int32_t *) = affineScalar;
+#ifdef NNUE_X86
+  if (simd == AVX2) {
+    clip = clipAvx2;
+    affine = affineAvx2;
+  } else if (simd == SSSE3) {
+    clip = clipSsse3;
+    affine = affineSsse3;
+  }
+#endif
+  uint8_t input[inputSize];
+  clip(accumulator.values[turn], input);
+  clip(accumulator.values[!turn], input + Accumulator::size);
+  int32_t hidden[l1Size];
+  affine(input, l1Weights.data(), l1Biases.data(), hidden);
+  int32_t output = outputBias;
+  for (int o = 0; o < l1Size; ++o) {
+    output += std::min(std::max(hidden[o] >> l1Shift, 0), 127) * outputWeights[o];
+  }
+  // a network can score anything, but scores past mateBound mean mates to
+  // the search
+  const int maxPoints = mateBound - 1;
+  return std::max(-maxPoints, std::min(maxPoints, output / outputDivisor));
+}
+
+int Network::evaluate(const Board &board) const {
+  Accumulator accumulator;
+  refresh(board, accumulator);
+  return evaluate(accumulator, board.getTurn());
+}
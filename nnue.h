@@ -0,0 +1,85 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "colour.h"
+#include "coord.h"
+#include "piece.h"
+
+class Board;
+
+// the first layer of a Network for both players: the biases plus the
+// columns of the features present, kept up to date by Board as pieces come
+// and go (see Board::setNetwork)
+// values[colour] is the position as colour sees it
+struct Accumulator {
+  static const int size = 256;
+  int16_t values[2][size];
+};
+
+// efficiently updatable neural network (NNUE) evaluation
+// the input features are the pieces on their squares as each player sees
+// them (own or enemy, piece type, square with the board flipped for black),
+// 768 in all; a move changes only a few, so the first layer is updated
+// rather than recomputed, see Accumulator
+// the rest of the network is small: both players' accumulators (the player
+// to move first) clipped to [0, 127], a layer of l1Size outputs with int8
+// weights, clipped again after dividing by 64, and the output with int8
+// weights, which divided by 16 is the score in centipawns
+// the dense layers run on the best instructions the CPU supports, see Simd
+//
+// network file: little-endian
+//   "NNUE", uint32 version (1), uint32 Accumulator::size, uint32 l1Size
+//   int16 feature weights [numFeatures][Accumulator::size]
+//   int16 feature biases [Accumulator::size]
+//   int8 l1 weights [l1Size][2 * Accumulator::size], int32 l1 biases [l1Size]
+//   int8 output weights [l1Size], int32 output bias
+class Network {
+public:
+  static const int numFeatures = 768;
+  static const int l1Size = 32;
+  // instruction sets of the dense layers, each computes the same result
+  enum Simd {
+    SCALAR,
+    SSSE3,
+    AVX2,
+  };
+private:
+  // a column of Accumulator::size per feature
+  std::vector<int16_t> featureWeights;
+  std::vector<int16_t> featureBiases;
+  // a row of 2 * Accumulator::size per output
+  std::vector<int8_t> l1Weights;
+  std::vector<int32_t> l1Biases;
+  std::vector<int8_t> outputWeights;
+  int32_t outputBias;
+  Simd simd;
+  Network();
+  // index of the feature of piece on coord as perspective sees it
+  static int feature(Colour perspective, Piece piece, Coord coord);
+public:
+  // throws std::logic_error if the file can't be read or is not a network
+  static std::unique_ptr<Network> load(std::istream &in);
+  static std::unique_ptr<Network> load(const std::string &path);
+  // the best instruction set of this CPU
+  static Simd supportedSimd();
+  Simd getSimd() const;
+  // defaults to supportedSimd(), an unsupported one is lowered to it
+  void setSimd(Simd simd);
+  // computes the accumulator of board from scratch
+  void refresh(const Board &board, Accumulator &accumulator) const;
+  void addPiece(Accumulator &accumulator, Piece piece, Coord coord) const;
+  void removePiece(Accumulator &accumulator, Piece piece, Coord coord) const;
+  // points (centipawns) from the perspective of turn, the player to move,
+  // kept strictly within +-mateBound (see score.h)
+  int evaluate(const Accumulator &accumulator, Colour turn) const;
+  // from scratch, for boards that don't keep an accumulator
+  int evaluate(const Board &board) const;
+};
+
+#endif
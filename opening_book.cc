@@ -0,0 +1,135 @@
+#include <cstdlib>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "board.h"
+#include "polyglot.h"
+
+#include "opening_book.h"
+
+namespace {
+
+uint64_t readBigEndian(const unsigned char *bytes, int size) {
+  uint64_t value = 0;
+  for (int i = 0; i < size; ++i) value = value << 8 | bytes[i];
+  return value;
+}
+
+void writeBigEndian(std::ostream &out, uint64_t value, int size) {
+  for (int i = size - 1; i >= 0; --i) out.put(static_cast<char>(value >> 8 * i));
+}
+
+// promotion pieces in Polyglot order, from 1
+const PieceType promotions[] = { KNIGHT, BISHOP, ROOK, QUEEN };
+
+}
+
+OpeningBook::Entry::Entry(Move move, int weight) : move{ move }, weight{ weight } {}
+
+OpeningBook::OpeningBook(const std::string &path) : fd{ -1 }, data{ nullptr }, numEntries{ 0 } {
+  fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw std::logic_error("Cannot open book " + path + ".");
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size % entrySize != 0) {
+    close(fd);
+    throw std::logic_error("Not a book file: " + path + ".");
+  }
+  numEntries = info.st_size / entrySize;
+  // an empty file can't be mapped, and has nothing to look up anyway
+  if (!numEntries) return;
+  void *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (mapped == MAP_FAILED) {
+    close(fd);
+    throw std::logic_error("Cannot map book " + path + ".");
+  }
+  data = static_cast<const unsigned char *>(mapped);
+}
+
+OpeningBook::~OpeningBook() {
+  if (data) munmap(const_cast<unsigned char *>(data), numEntries * entrySize);
+  close(fd);
+}
+
+uint64_t OpeningBook::keyAt(std::size_t index) const {
+  return readBigEndian(data + index * entrySize, 8);
+}
+
+std::vector<OpeningBook::Entry> OpeningBook::lookup(const Board &board) const {
+  std::vector<Entry> entries;
+  uint64_t key = polyglotKey(board);
+  // first entry with the key
+  std::size_t low = 0, high = numEntries;
+  while (low < high) {
+    std::size_t mid = low + (high - low) / 2;
+    if (keyAt(mid) < key) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  for (std::size_t i = low; i < numEntries && keyAt(i) == key; ++i) {
+    const unsigned char *entry = data + i * entrySize;
+    Move move = decodeMove(board, readBigEndian(entry + 8, 2));
+    int weight = readBigEndian(entry + 10, 2);
+    // another position with the same key, or a corrupt entry
+    if (!board.isLegalMove(move)) continue;
+    entries.emplace_back(move, weight);
+  }
+  return entries;
+}
+
+std::unique_ptr<Move> OpeningBook::pick(const Board &board, std::mt19937_64 &rng) const {
+  std::vector<Entry> entries = lookup(board);
+  uint64_t totalWeight = 0;
+  for (const Entry &entry : entries) totalWeight += entry.weight;
+  // a position whose moves all have weight 0 is in the book but shouldn't be
+  // played from it
+  if (!totalWeight) return nullptr;
+  uint64_t choice = rng() % totalWeight;
+  for (const Entry &entry : entries) {
+    if (choice < static_cast<uint64_t>(entry.weight)) return std::make_unique<Move>(entry.move);
+    choice -= entry.weight;
+  }
+  return nullptr;
+}
+
+std::size_t OpeningBook::size() const {
+  return numEntries;
+}
+
+uint16_t OpeningBook::encodeMove(const Board &board, const Move &move) {
+  Coord to = move.to;
+  const Piece *piece = board.at(move.from.row, move.from.col);
+  if (piece && piece->type == KING && std::abs(to.col - move.from.col) == 2) {
+    to.col = to.col > move.from.col ? 7 : 0;
+  }
+  int promotion = 0;
+  for (int i = 0; i < 4; ++i) {
+    if (move.promoteTo == promotions[i]) promotion = i + 1;
+  }
+  return to.col | to.row << 3 | move.from.col << 6 | move.from.row << 9 | promotion << 12;
+}
+
+Move OpeningBook::decodeMove(const Board &board, uint16_t bits) {
+  Coord from((bits >> 9) & 7, (bits >> 6) & 7), to((bits >> 3) & 7, bits & 7);
+  int promotion = (bits >> 12) & 7;
+  PieceType promoteTo = promotion >= 1 && promotion <= 4 ? promotions[promotion - 1] : PAWN;
+  const Piece *piece = board.at(from.row, from.col);
+  const Piece *target = board.at(to.row, to.col);
+  if (piece && piece->type == KING && target && target->colour == piece->colour
+      && target->type == ROOK) {
+    to.col = to.col > from.col ? 6 : 2;
+  }
+  return Move(from, to, promoteTo);
+}
+
+void OpeningBook::writeEntry(std::ostream &out, uint64_t key, uint16_t move, uint16_t weight, uint32_t learn) {
+  writeBigEndian(out, key, 8);
+  writeBigEndian(out, move, 2);
+  writeBigEndian(out, weight, 2);
+  writeBigEndian(out, learn, 4);
+}
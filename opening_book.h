@@ -0,0 +1,58 @@
+#ifndef OPENING_BOOK_H
+#define OPENING_BOOK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "move.h"
+
+class Board;
+
+// read-only opening book: a file of 16-byte entries sorted by key, each
+// (big-endian) a uint64 key, a uint16 move, a uint16 weight and a uint32
+// learn field, the layout, keys (see polyglotKey) and move encoding of
+// Polyglot books, so books written by bookbuild or other Polyglot tools both
+// work
+// the file is memory-mapped rather than read, so opening a book costs nothing
+// however large it is, and lookups only touch the pages a binary search
+// visits
+class OpeningBook {
+public:
+  struct Entry {
+    Move move;
+    int weight;
+    Entry(Move move, int weight);
+  };
+  static const std::size_t entrySize = 16;
+private:
+  int fd;
+  const unsigned char *data;
+  std::size_t numEntries;
+  uint64_t keyAt(std::size_t index) const;
+public:
+  // throws std::logic_error if the file can't be opened or is not a book
+  explicit OpeningBook(const std::string &path);
+  OpeningBook(const OpeningBook &) = delete;
+  OpeningBook &operator=(const OpeningBook &) = delete;
+  ~OpeningBook();
+  // the legal book moves of board with their weights, in book order
+  std::vector<Entry> lookup(const Board &board) const;
+  // a book move of board picked at random in proportion to the weights,
+  // null if board is not in the book
+  std::unique_ptr<Move> pick(const Board &board, std::mt19937_64 &rng) const;
+  std::size_t size() const;
+  // the Polyglot encoding of move, a legal move of board: castling is the
+  // king capturing its own rook
+  static uint16_t encodeMove(const Board &board, const Move &move);
+  static Move decodeMove(const Board &board, uint16_t bits);
+  // writes an entry in the book format, entries must be written sorted by
+  // key
+  static void writeEntry(std::ostream &out, uint64_t key, uint16_t move, uint16_t weight, uint32_t learn);
+};
+
+#endif
@@ -0,0 +1,43 @@
+#include <algorithm>
+
+#include "pawn_table.h"
+
+// key 0 is the structure with no pawns, which is what an empty entry holds
+PawnTable::Entry::Entry() : key{ 0 }, score{ 0, 0 }, files{ 0, 0 } {}
+
+PawnTable::PawnTable(std::size_t numEntries) : probes{ 0 }, hits{ 0 } {
+  std::size_t size = 1;
+  while (size * 2 <= std::max<std::size_t>(1, numEntries)) size *= 2;
+  entries.resize(size);
+  mask = size - 1;
+}
+
+void PawnTable::clear() {
+  std::fill(entries.begin(), entries.end(), Entry());
+  probes = 0;
+  hits = 0;
+}
+
+PawnTable::Entry &PawnTable::probe(uint64_t key, bool &found) {
+  ++probes;
+  Entry &entry = entries[key & mask];
+  found = entry.key == key;
+  if (found) ++hits;
+  return entry;
+}
+
+std::size_t PawnTable::numEntries() const {
+  return entries.size();
+}
+
+uint64_t PawnTable::numProbes() const {
+  return probes;
+}
+
+uint64_t PawnTable::numHits() const {
+  return hits;
+}
+
+double PawnTable::hitRate() const {
+  return probes ? static_cast<double>(hits) / probes : 0;
+}
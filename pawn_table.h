@@ -0,0 +1,44 @@
+#ifndef PAWN_TABLE_H
+#define PAWN_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// fixed-size hash table of pawn structure evaluations keyed by
+// Board::getPawnHash(), see Evaluator
+// pawns move rarely next to the other pieces, so most positions a search
+// reaches find their pawn structure here
+// an entry is overwritten by any other structure mapping to it
+// not thread safe: every search thread has its own
+class PawnTable {
+public:
+  struct Entry {
+    uint64_t key;
+    // white's points minus black's, indexed by GamePhase
+    int16_t score[2];
+    // indexed by colour, bit col is set if colour has a pawn on column col
+    uint8_t files[2];
+    Entry();
+  };
+private:
+  std::vector<Entry> entries;
+  // number of entries - 1, the number of entries is a power of two
+  uint64_t mask;
+  uint64_t probes, hits;
+public:
+  // size is rounded down to a power of two number of entries
+  explicit PawnTable(std::size_t numEntries = 1 << 14);
+  // forgets all entries and statistics
+  void clear();
+  // the entry for key, found is set to whether it holds key
+  // if not, the caller must fill it in and set its key
+  Entry &probe(uint64_t key, bool &found);
+  std::size_t numEntries() const;
+  uint64_t numProbes() const;
+  uint64_t numHits() const;
+  // fraction of probes that found their structure, 0 if nothing was probed
+  double hitRate() const;
+};
+
+#endif
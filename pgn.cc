@@ -0,0 +1,191 @@
+#include <cctype>
+#include <stdexcept>
+
+#include "board.h"
+
+#include "pgn.h"
+
+namespace {
+
+bool parseResult(const std::string &token, PgnGame::Result &result) {
+  if (token == "1-0") {
+    result = PgnGame::WHITE_WINS;
+  } else if (token == "0-1") {
+    result = PgnGame::BLACK_WINS;
+  } else if (token == "1/2-1/2") {
+    result = PgnGame::DRAW;
+  } else if (token == "*") {
+    result = PgnGame::UNKNOWN;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool pieceTypeOf(char c, PieceType &type) {
+  switch (c) {
+  case 'N':
+    type = KNIGHT;
+    break;
+  case 'B':
+    type = BISHOP;
+    break;
+  case 'R':
+    type = ROOK;
+    break;
+  case 'Q':
+    type = QUEEN;
+    break;
+  case 'K':
+    type = KING;
+    break;
+  default:
+    return false;
+  }
+  return true;
+}
+
+bool isFile(char c) {
+  return c >= 'a' && c <= 'h';
+}
+
+bool isRank(char c) {
+  return c >= '1' && c <= '8';
+}
+
+}
+
+PgnGame::PgnGame() : result{ UNKNOWN } {}
+
+PgnReader::PgnReader(std::istream &in) : in(in) {}
+
+bool PgnReader::next(std::string &text) {
+  text = pending;
+  pending.clear();
+  bool hasMoves = false;
+  std::string line;
+  while (getline(in, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    bool isTag = !line.empty() && line[0] == '[';
+    // a tag after the moves starts the next game
+    if (isTag && hasMoves) {
+      pending = line + "\n";
+      return true;
+    }
+    if (!isTag && line.find_first_not_of(" \t") != std::string::npos) hasMoves = true;
+    text += line;
+    text += '\n';
+  }
+  return text.find_first_not_of(" \t\n") != std::string::npos;
+}
+
+PgnGame parsePgn(const std::string &text) {
+  PgnGame game;
+  bool hasResultTag = false;
+  int variationDepth = 0;
+  std::size_t i = 0;
+  while (i < text.size()) {
+    char c = text[i];
+    if (c == '[' && (i == 0 || text[i - 1] == '\n')) {
+      std::size_t end = text.find('\n', i);
+      std::string tag = text.substr(i, end - i);
+      std::size_t quote = tag.find('"');
+      if (quote != std::string::npos) {
+        std::string value = tag.substr(quote + 1, tag.find('"', quote + 1) - quote - 1);
+        if (tag.compare(0, 8, "[Result ") == 0) {
+          hasResultTag = parseResult(value, game.result);
+        } else if (tag.compare(0, 5, "[FEN ") == 0) {
+          game.fen = value;
+        }
+      }
+      i = end == std::string::npos ? text.size() : end;
+    } else if (c == '{') {
+      std::size_t end = text.find('}', i);
+      i = end == std::string::npos ? text.size() : end + 1;
+    } else if (c == ';' || (c == '%' && (i == 0 || text[i - 1] == '\n'))) {
+      std::size_t end = text.find('\n', i);
+      i = end == std::string::npos ? text.size() : end;
+    } else if (c == '(') {
+      ++variationDepth;
+      ++i;
+    } else if (c == ')') {
+      if (variationDepth) --variationDepth;
+      ++i;
+    } else if (std::isspace(static_cast<unsigned char>(c))) {
+      ++i;
+    } else {
+      std::size_t end = i;
+      while (end < text.size() && !std::isspace(static_cast<unsigned char>(text[end]))
+          && text[end] != '{' && text[end] != '(' && text[end] != ')' && text[end] != ';') {
+        ++end;
+      }
+      std::string token = text.substr(i, end - i);
+      i = end;
+      if (variationDepth || token[0] == '$') continue;
+      PgnGame::Result result;
+      if (parseResult(token, result)) {
+        if (!hasResultTag) game.result = result;
+        break;
+      }
+      // move numbers, possibly stuck to the move (12.e4, 12...e5)
+      std::size_t start = 0;
+      while (start < token.size() && std::isdigit(static_cast<unsigned char>(token[start]))) ++start;
+      if (start < token.size() && token[start] == '.') {
+        while (start < token.size() && token[start] == '.') ++start;
+      } else {
+        start = 0;
+      }
+      if (start < token.size()) game.moves.push_back(token.substr(start));
+    }
+  }
+  return game;
+}
+
+Move parseSan(const Board &board, const std::string &san) {
+  std::string s = san;
+  // check, mate and annotation marks
+  while (!s.empty() && (s.back() == '+' || s.back() == '#' || s.back() == '!' || s.back() == '?')) {
+    s.pop_back();
+  }
+  int row = board.getTurn() == WHITE ? 0 : 7;
+  if (s == "O-O" || s == "0-0") return Move(Coord(row, 4), Coord(row, 6));
+  if (s == "O-O-O" || s == "0-0-0") return Move(Coord(row, 4), Coord(row, 2));
+
+  PieceType promoteTo = PAWN;
+  if (s.size() >= 2 && pieceTypeOf(s.back(), promoteTo)) {
+    s.pop_back();
+    if (!s.empty() && s.back() == '=') s.pop_back();
+  }
+  PieceType type = PAWN;
+  std::size_t start = 0;
+  if (!s.empty() && pieceTypeOf(s[0], type)) start = 1;
+  if (s.size() < start + 2 || !isFile(s[s.size() - 2]) || !isRank(s.back())) {
+    throw std::logic_error("Invalid move " + san + ".");
+  }
+  Coord to(s.back() - '1', s[s.size() - 2] - 'a');
+  // whatever is between the piece and the destination says which piece moves
+  int fromRow = -1, fromCol = -1;
+  for (std::size_t i = start; i + 2 < s.size(); ++i) {
+    if (isFile(s[i])) {
+      fromCol = s[i] - 'a';
+    } else if (isRank(s[i])) {
+      fromRow = s[i] - '1';
+    } else if (s[i] != 'x' && s[i] != '-') {
+      throw std::logic_error("Invalid move " + san + ".");
+    }
+  }
+
+  const Move *found = nullptr;
+  std::vector<Move> moves = board.legalMoves();
+  for (const Move &move : moves) {
+    const Piece *piece = board.at(move.from.row, move.from.col);
+    if (move.to != to || move.promoteTo != promoteTo || piece->type != type
+        || (fromRow >= 0 && move.from.row != fromRow) || (fromCol >= 0 && move.from.col != fromCol)) {
+      continue;
+    }
+    if (found) throw std::logic_error("Ambiguous move " + san + ".");
+    found = &move;
+  }
+  if (!found) throw std::logic_error("Illegal move " + san + ".");
+  return *found;
+}
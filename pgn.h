@@ -0,0 +1,51 @@
+#ifndef PGN_H
+#define PGN_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "move.h"
+
+class Board;
+
+// a game read from PGN (portable game notation)
+struct PgnGame {
+  enum Result {
+    WHITE_WINS,
+    BLACK_WINS,
+    DRAW,
+    // unfinished, or no result given
+    UNKNOWN,
+  };
+  Result result;
+  // the FEN tag, the position the game starts from, empty for the initial
+  // position
+  std::string fen;
+  // in standard algebraic notation (SAN), see parseSan
+  std::vector<std::string> moves;
+  PgnGame();
+};
+
+// splits a stream of PGN into the text of each game, one game at a time, so
+// files of any size are read in bounded memory
+class PgnReader {
+  std::istream &in;
+  // the first tag line of the next game, read while looking for the end of
+  // the last one
+  std::string pending;
+public:
+  explicit PgnReader(std::istream &in);
+  // sets text to the next game's tags and moves, returns false at the end
+  bool next(std::string &text);
+};
+
+// the result and moves of the text of a game (see PgnReader), skipping
+// comments, variations, move numbers and annotations
+PgnGame parsePgn(const std::string &text);
+
+// the legal move of board written as san (e.g. e4, Nbd7, exd8=Q+, O-O)
+// throws std::logic_error if there is no such move, or more than one
+Move parseSan(const Board &board, const std::string &san);
+
+#endif
@@ -0,0 +1,155 @@
+#include "piece_values.h"
+
+namespace {
+
+// tables are written from white's point of view with the 8th row first, so
+// they read like the board printed by TextDisplay
+typedef int Table[8][8];
+
+const Table pawnTable = {
+  {   0,   0,   0,   0,   0,   0,   0,   0 },
+  {  50,  50,  50,  50,  50,  50,  50,  50 },
+  {  10,  10,  20,  30,  30,  20,  10,  10 },
+  {   5,   5,  10,  25,  25,  10,   5,   5 },
+  {   0,   0,   0,  20,  20,   0,   0,   0 },
+  {   5,  -5, -10,   0,   0, -10,  -5,   5 },
+  {   5,  10,  10, -20, -20,  10,  10,   5 },
+  {   0,   0,   0,   0,   0,   0,   0,   0 },
+};
+
+const Table knightTable = {
+  { -50, -40, -30, -30, -30, -30, -40, -50 },
+  { -40, -20,   0,   0,   0,   0, -20, -40 },
+  { -30,   0,  10,  15,  15,  10,   0, -30 },
+  { -30,   5,  15,  20,  20,  15,   5, -30 },
+  { -30,   0,  15,  20,  20,  15,   0, -30 },
+  { -30,   5,  10,  15,  15,  10,   5, -30 },
+  { -40, -20,   0,   5,   5,   0, -20, -40 },
+  { -50, -40, -30, -30, -30, -30, -40, -50 },
+};
+
+const Table bishopTable = {
+  { -20, -10, -10, -10, -10, -10, -10, -20 },
+  { -10,   0,   0,   0,   0,   0,   0, -10 },
+  { -10,   0,   5,  10,  10,   5,   0, -10 },
+  { -10,   5,   5,  10,  10,   5,   5, -10 },
+  { -10,   0,  10,  10,  10,  10,   0, -10 },
+  { -10,  10,  10,  10,  10,  10,  10, -10 },
+  { -10,   5,   0,   0,   0,   0,   5, -10 },
+  { -20, -10, -10, -10, -10, -10, -10, -20 },
+};
+
+const Table rookTable = {
+  {   0,   0,   0,   0,   0,   0,   0,   0 },
+  {   5,  10,  10,  10,  10,  10,  10,   5 },
+  {  -5,   0,   0,   0,   0,   0,   0,  -5 },
+  {  -5,   0,   0,   0,   0,   0,   0,  -5 },
+  {  -5,   0,   0,   0,   0,   0,   0,  -5 },
+  {  -5,   0,   0,   0,   0,   0,   0,  -5 },
+  {  -5,   0,   0,   0,   0,   0,   0,  -5 },
+  {   0,   0,   0,   5,   5,   0,   0,   0 },
+};
+
+const Table queenTable = {
+  { -20, -10, -10,  -5,  -5, -10, -10, -20 },
+  { -10,   0,   0,   0,   0,   0,   0, -10 },
+  { -10,   0,   5,   5,   5,   5,   0, -10 },
+  {  -5,   0,   5,   5,   5,   5,   0,  -5 },
+  {   0,   0,   5,   5,   5,   5,   0,  -5 },
+  { -10,   5,   5,   5,   5,   5,   0, -10 },
+  { -10,   0,   5,   0,   0,   0,   0, -10 },
+  { -20, -10, -10,  -5,  -5, -10, -10, -20 },
+};
+
+const Table kingTable = {
+  { -30, -40, -40, -50, -50, -40, -40, -30 },
+  { -30, -40, -40, -50, -50, -40, -40, -30 },
+  { -30, -40, -40, -50, -50, -40, -40, -30 },
+  { -30, -40, -40, -50, -50, -40, -40, -30 },
+  { -20, -30, -30, -40, -40, -30, -30, -20 },
+  { -10, -20, -20, -20, -20, -20, -20, -10 },
+  {  20,  20,   0,   0,   0,   0,  20,  20 },
+  {  20,  30,  10,   0,   0,  10,  30,  20 },
+};
+
+const Table pawnEndgameTable = {
+  {   0,   0,   0,   0,   0,   0,   0,   0 },
+  {  80,  80,  80,  80,  80,  80,  80,  80 },
+  {  50,  50,  50,  50,  50,  50,  50,  50 },
+  {  30,  30,  30,  30,  30,  30,  30,  30 },
+  {  20,  20,  20,  20,  20,  20,  20,  20 },
+  {  10,  10,  10,  10,  10,  10,  10,  10 },
+  {  10,  10,  10,  10,  10,  10,  10,  10 },
+  {   0,   0,   0,   0,   0,   0,   0,   0 },
+};
+
+const Table kingEndgameTable = {
+  { -50, -40, -30, -20, -20, -30, -40, -50 },
+  { -30, -20, -10,   0,   0, -10, -20, -30 },
+  { -30, -10,  20,  30,  30,  20, -10, -30 },
+  { -30, -10,  30,  40,  40,  30, -10, -30 },
+  { -30, -10,  30,  40,  40,  30, -10, -30 },
+  { -30, -10,  20,  30,  30,  20, -10, -30 },
+  { -30, -30,   0,   0,   0,   0, -30, -30 },
+  { -50, -30, -30, -30, -30, -30, -30, -50 },
+};
+
+// the other pieces use the same table in both phases
+const Table &tableFor(PieceType type, GamePhase phase) {
+  switch (type) {
+  case PAWN:
+    return phase == ENDGAME ? pawnEndgameTable : pawnTable;
+  case ROOK:
+    return rookTable;
+  case KNIGHT:
+    return knightTable;
+  case BISHOP:
+    return bishopTable;
+  case QUEEN:
+    return queenTable;
+  case KING:
+    break;
+  }
+  return phase == ENDGAME ? kingEndgameTable : kingTable;
+}
+
+}
+
+int pieceValue(PieceType type) {
+  switch (type) {
+  case PAWN:
+    return 100;
+  case ROOK:
+    return 500;
+  case KNIGHT:
+  case BISHOP:
+    return 300;
+  case QUEEN:
+    return 900;
+  case KING:
+    break;
+  }
+  return 0;
+}
+
+int pieceSquareValue(Piece piece, Coord coord, GamePhase phase) {
+  // white's first row is the last row of the table, black's is the first
+  int row = piece.colour == WHITE ? 7 - coord.row : coord.row;
+  return tableFor(piece.type, phase)[row][coord.col];
+}
+
+int phaseWeight(PieceType type) {
+  switch (type) {
+  case KNIGHT:
+  case BISHOP:
+    return 1;
+  case ROOK:
+    return 2;
+  case QUEEN:
+    return 4;
+  case PAWN:
+  case KING:
+    break;
+  }
+  return 0;
+}
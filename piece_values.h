@@ -0,0 +1,32 @@
+#ifndef PIECE_VALUES_H
+#define PIECE_VALUES_H
+
+#include "coord.h"
+#include "piece.h"
+#include "piece_type.h"
+
+// value of a piece in centipawns (a pawn is 100)
+// the king is never captured, so it is worth 0
+int pieceValue(PieceType type);
+
+// an evaluation term has a middlegame and an endgame value, and is
+// interpolated between them by how much material is left (tapered
+// evaluation, see phaseWeight)
+enum GamePhase {
+  MIDDLEGAME,
+  ENDGAME,
+};
+
+// bonus in centipawns for a piece standing on coord: pieces are worth more
+// on squares where they are more active or safer
+// kings shelter in the middlegame and centralise in the endgame, pawns
+// become worth more as they advance
+int pieceSquareValue(Piece piece, Coord coord, GamePhase phase);
+
+// how much a piece counts towards the middlegame: the phase of a position is
+// the sum over all pieces, maxPhase at the start (more after promotions) and
+// 0 when only kings and pawns are left
+int phaseWeight(PieceType type);
+const int maxPhase = 24;
+
+#endif
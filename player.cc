@@ -1,3 +1,11 @@
 #include "player.h"
 
 Player::~Player() {}
+
+void Player::startPondering(const Board &) {}
+
+void Player::stopPondering() {}
+
+void Player::reportMove(std::ostream &, Colour) const {}
+
+void Player::reportGame(std::ostream &, Colour) const {}
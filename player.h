@@ -2,6 +2,8 @@
 #define PLAYER_H
 
 #include "action.h"
+#include "colour.h"
+#include <iostream>
 #include <memory>
 
 class Board;
@@ -10,6 +12,17 @@ class Player {
 public:
   virtual ~Player() = 0;
   virtual std::unique_ptr<Action> getAction(const Board &board) = 0;
+  // called with the position after the player's move, while the opponent
+  // thinks about theirs: a player may use the time to think ahead
+  // must return without waiting for the opponent
+  virtual void startPondering(const Board &board);
+  // called when the game ends, getAction stops pondering by itself
+  virtual void stopPondering();
+  // called after each of the player's actions, and once more when the game
+  // ends: a player may print what it did to find its move, and the totals
+  // for the game, colour is the colour the player plays
+  virtual void reportMove(std::ostream &out, Colour colour) const;
+  virtual void reportGame(std::ostream &out, Colour colour) const;
 };
 
 #endif
@@ -0,0 +1,16 @@
+#ifndef POLYGLOT_H
+#define POLYGLOT_H
+
+#include <cstdint>
+
+class Board;
+
+// the key of board in Polyglot opening books, the xor of entries of the
+// Polyglot Random64 table for the pieces, castling rights, en passant file
+// and turn, so books written by other Polyglot tools work with this engine
+// unlike Board::getHash(), the en passant file only counts when a pawn of
+// the player to move stands next to the pawn that just advanced two squares,
+// whether or not the capture would be legal
+uint64_t polyglotKey(const Board &board);
+
+#endif
@@ -0,0 +1,31 @@
+#include <cstdlib>
+
+#include "score.h"
+
+int mateIn(int ply) {
+  return mateScore - ply;
+}
+
+int matedIn(int ply) {
+  return -mateScore + ply;
+}
+
+bool isMateScore(int score) {
+  return std::abs(score) > mateBound;
+}
+
+int matePlies(int score) {
+  return mateScore - std::abs(score);
+}
+
+int scoreToTable(int score, int ply) {
+  if (score > mateBound) return score + ply;
+  if (score < -mateBound) return score - ply;
+  return score;
+}
+
+int scoreFromTable(int score, int ply) {
+  if (score > mateBound) return score - ply;
+  if (score < -mateBound) return score + ply;
+  return score;
+}
@@ -0,0 +1,28 @@
+#ifndef SCORE_H
+#define SCORE_H
+
+// search scores are centipawns from the perspective of the player to move,
+// except for forced mates: mate in n plies (counted from the root of the
+// search) is mateScore - n, getting mated in n plies is -(mateScore - n)
+// so a faster mate always scores higher and every score can be negated
+// safely
+
+// beyond any score, for alpha-beta windows
+const int infiniteScore = 32000;
+const int mateScore = 31000;
+// no search reaches this many plies, so scores beyond +-mateBound are mates
+const int mateBound = mateScore - 1000;
+
+// score of mating, or getting mated, ply plies from the root
+int mateIn(int ply);
+int matedIn(int ply);
+bool isMateScore(int score);
+// number of plies to the mate of a mate score
+int matePlies(int score);
+// mate scores are stored in the transposition table relative to the stored
+// node rather than to the root, since the same node is reached at different
+// plies
+int scoreToTable(int score, int ply);
+int scoreFromTable(int score, int ply);
+
+#endif
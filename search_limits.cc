@@ -0,0 +1,6 @@
+#include "search_limits.h"
+
+SearchLimits::SearchLimits(int maxDepth, uint64_t maxNodes,
+    std::chrono::milliseconds moveTime)
+  : maxDepth{ maxDepth }, maxNodes{ maxNodes }, moveTime{ moveTime }
+{}
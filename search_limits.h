@@ -0,0 +1,20 @@
+#ifndef SEARCH_LIMITS_H
+#define SEARCH_LIMITS_H
+
+#include <chrono>
+#include <cstdint>
+
+// bounds on how much work an engine may spend on a single move
+// the search stops at whichever limit is reached first
+struct SearchLimits {
+  // in plies, counting the engine's own move
+  int maxDepth;
+  // 0 means no limit
+  uint64_t maxNodes;
+  // 0 means no limit
+  std::chrono::milliseconds moveTime;
+  SearchLimits(int maxDepth = 64, uint64_t maxNodes = 0,
+    std::chrono::milliseconds moveTime = std::chrono::milliseconds(2000));
+};
+
+#endif
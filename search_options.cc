@@ -0,0 +1,13 @@
+#include "search_options.h"
+
+SearchOptions::SearchOptions()
+  : hashMegabytes{ 16 }
+  , evalCacheMegabytes{ 2 }
+  , seePruning{ true }
+  , threads{ 1 }
+  , nullMovePruning{ true }
+  , lateMoveReductions{ true }
+  , ponder{ false }
+  , reportStats{ true }
+  , traceEvents{ 0 }
+{}
@@ -0,0 +1,48 @@
+#ifndef SEARCH_OPTIONS_H
+#define SEARCH_OPTIONS_H
+
+#include <cstddef>
+#include <string>
+
+// tuning switches of an engine's search, as opposed to the per move budget in
+// SearchLimits
+struct SearchOptions {
+  // size of the transposition table
+  std::size_t hashMegabytes;
+  // size of the cache of static evaluations shared by all threads, 0 for none
+  std::size_t evalCacheMegabytes;
+  // in quiescence search, skip captures that lose material according to
+  // static exchange evaluation
+  bool seePruning;
+  // number of threads searching in parallel, at least 1
+  int threads;
+  // let the opponent move twice in a row, and prune if we are still above
+  // beta after a reduced search
+  // skipped when the side to move has only pawns, where passing may be better
+  // than every move (zugzwang)
+  bool nullMovePruning;
+  // search quiet moves ordered late to a reduced depth, searching them again
+  // to full depth if they turn out better than expected
+  bool lateMoveReductions;
+  // keep searching on the opponent's time, on the position after the reply
+  // the principal variation predicts (see Player::startPondering)
+  bool ponder;
+  // print the stats of each search after the move, and their totals when
+  // the game ends (see Player::reportMove)
+  bool reportStats;
+  // number of events each thread keeps of the last search (see SearchTrace),
+  // 0 disables tracing
+  std::size_t traceEvents;
+  // when tracing, every search is written when it ends to this path with
+  // the number of the search appended (.1, .2...), unless empty
+  std::string traceFile;
+  // evaluate with the network in this file (see Network) instead of the
+  // hand-written evaluation, unless empty
+  std::string networkFile;
+  // play the moves of the opening book in this file (see OpeningBook) while
+  // the game is in it, unless empty
+  std::string bookFile;
+  SearchOptions();
+};
+
+#endif
@@ -0,0 +1,80 @@
+#include <algorithm>
+
+#include "search_stats.h"
+
+SearchStats::SearchStats()
+  : searches{ 0 }
+  , nodes{ 0 }
+  , qnodes{ 0 }
+  , depth{ 0 }
+  , selDepth{ 0 }
+  , betaCutoffs{ 0 }
+  , firstMoveCutoffs{ 0 }
+  , ttProbes{ 0 }
+  , ttHits{ 0 }
+  , pawnProbes{ 0 }
+  , pawnHits{ 0 }
+  , evalProbes{ 0 }
+  , evalHits{ 0 }
+  , millis{ 0 }
+{}
+
+double SearchStats::nodesPerSecond() const {
+  return millis > 0 ? nodes * 1000 / millis : 0;
+}
+
+double SearchStats::betaCutoffRate() const {
+  return nodes ? static_cast<double>(betaCutoffs) / nodes : 0;
+}
+
+double SearchStats::firstMoveCutoffRate() const {
+  return betaCutoffs ? static_cast<double>(firstMoveCutoffs) / betaCutoffs : 0;
+}
+
+double SearchStats::ttHitRate() const {
+  return ttProbes ? static_cast<double>(ttHits) / ttProbes : 0;
+}
+
+double SearchStats::pawnHitRate() const {
+  return pawnProbes ? static_cast<double>(pawnHits) / pawnProbes : 0;
+}
+
+double SearchStats::evalHitRate() const {
+  return evalProbes ? static_cast<double>(evalHits) / evalProbes : 0;
+}
+
+void SearchStats::add(const SearchStats &other) {
+  searches += other.searches;
+  nodes += other.nodes;
+  qnodes += other.qnodes;
+  depth = std::max(depth, other.depth);
+  selDepth = std::max(selDepth, other.selDepth);
+  betaCutoffs += other.betaCutoffs;
+  firstMoveCutoffs += other.firstMoveCutoffs;
+  ttProbes += other.ttProbes;
+  ttHits += other.ttHits;
+  pawnProbes += other.pawnProbes;
+  pawnHits += other.pawnHits;
+  evalProbes += other.evalProbes;
+  evalHits += other.evalHits;
+  millis += other.millis;
+  iterationMillis.clear();
+}
+
+std::ostream &operator<<(std::ostream &out, const SearchStats &stats) {
+  out << "searches " << stats.searches
+    << " depth " << stats.depth << "/" << stats.selDepth
+    << " nodes " << stats.nodes << " qnodes " << stats.qnodes
+    << " nps " << static_cast<uint64_t>(stats.nodesPerSecond())
+    << " cutoffs " << stats.betaCutoffRate()
+    << " first " << stats.firstMoveCutoffRate()
+    << " tt " << stats.ttHits << "/" << stats.ttProbes
+    << " pawns " << stats.pawnHits << "/" << stats.pawnProbes
+    << " evals " << stats.evalHits << "/" << stats.evalProbes
+    << " time " << stats.millis << "ms";
+  if (!stats.iterationMillis.empty()) {
+    out << " iterations";
+    for (double millis : stats.iterationMillis) out << " " << millis;
+  }
+  return out;
+}
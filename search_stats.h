@@ -0,0 +1,48 @@
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// work done by a search, or summed over several searches (see add)
+struct SearchStats {
+  // number of searches summed
+  int searches;
+  // all nodes, quiescence nodes included
+  uint64_t nodes;
+  uint64_t qnodes;
+  // deepest completed iteration, and the deepest ply reached (including
+  // quiescence search), the maximum over all searches when summed
+  int depth;
+  int selDepth;
+  uint64_t betaCutoffs;
+  // beta cutoffs caused by the first move searched at a node
+  uint64_t firstMoveCutoffs;
+  uint64_t ttProbes, ttHits;
+  // of the pawn tables of every thread, see Evaluator
+  uint64_t pawnProbes, pawnHits;
+  // of the evaluation cache, see EvalCache
+  uint64_t evalProbes, evalHits;
+  // wall time of the whole search, and of each iteration the main searcher
+  // completed (empty when summed)
+  double millis;
+  std::vector<double> iterationMillis;
+  SearchStats();
+  double nodesPerSecond() const;
+  // fraction of nodes that failed high
+  double betaCutoffRate() const;
+  // fraction of beta cutoffs caused by the first move searched, a measure of
+  // move ordering quality
+  double firstMoveCutoffRate() const;
+  double ttHitRate() const;
+  double pawnHitRate() const;
+  double evalHitRate() const;
+  // adds the work of other, another search
+  void add(const SearchStats &other);
+};
+
+// prints the stats on a single line
+std::ostream &operator<<(std::ostream &out, const SearchStats &stats);
+
+#endif
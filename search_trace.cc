@@ -0,0 +1,111 @@
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#include "search_trace.h"
+
+namespace {
+
+const char magic[4] = { 'C', 'T', 'R', 'C' };
+const uint32_t version = 1;
+
+static_assert(sizeof(TraceEvent) == 20, "trace files store events as they are in memory");
+
+template<typename T>
+void writeValue(std::ostream &out, T value) {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template<typename T>
+bool readValue(std::istream &in, T &value) {
+  return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value)));
+}
+
+}
+
+TraceBuffer::TraceBuffer(std::size_t capacity) : recorded{ 0 } {
+  std::size_t size = 1;
+  while (size < capacity) size *= 2;
+  events.resize(size);
+  mask = size - 1;
+}
+
+void TraceBuffer::clear() {
+  recorded = 0;
+}
+
+uint64_t TraceBuffer::numRecorded() const {
+  return recorded;
+}
+
+std::vector<TraceEvent> TraceBuffer::held() const {
+  std::vector<TraceEvent> result;
+  uint64_t first = recorded > events.size() ? recorded - events.size() : 0;
+  result.reserve(recorded - first);
+  for (uint64_t i = first; i < recorded; ++i) result.push_back(events[i & mask]);
+  return result;
+}
+
+void TraceBuffer::assign(uint64_t recorded, const std::vector<TraceEvent> &events) {
+  *this = TraceBuffer(events.size());
+  // the held events are the last ones recorded
+  this->recorded = recorded;
+  uint64_t first = recorded - events.size();
+  for (size_t i = 0; i < events.size(); ++i) this->events[(first + i) & mask] = events[i];
+}
+
+SearchTrace::SearchTrace(int threads, std::size_t eventsPerThread) {
+  for (int i = 0; i < threads; ++i) buffers.emplace_back(eventsPerThread);
+}
+
+int SearchTrace::numThreads() const {
+  return buffers.size();
+}
+
+TraceBuffer &SearchTrace::thread(int index) {
+  return buffers.at(index);
+}
+
+const TraceBuffer &SearchTrace::thread(int index) const {
+  return buffers.at(index);
+}
+
+void SearchTrace::clear() {
+  for (TraceBuffer &buffer : buffers) buffer.clear();
+}
+
+bool SearchTrace::write(const std::string &path) const {
+  std::ofstream out(path, std::ios::binary);
+  if (!out) return false;
+  out.write(magic, sizeof(magic));
+  writeValue<uint32_t>(out, version);
+  writeValue<uint32_t>(out, buffers.size());
+  for (const TraceBuffer &buffer : buffers) {
+    std::vector<TraceEvent> events = buffer.held();
+    writeValue<uint64_t>(out, buffer.numRecorded());
+    writeValue<uint64_t>(out, events.size());
+    out.write(reinterpret_cast<const char *>(events.data()), events.size() * sizeof(TraceEvent));
+  }
+  return static_cast<bool>(out);
+}
+
+bool SearchTrace::read(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  char fileMagic[sizeof(magic)];
+  uint32_t fileVersion, threads;
+  if (!in.read(fileMagic, sizeof(fileMagic)) || std::memcmp(fileMagic, magic, sizeof(magic)) != 0
+      || !readValue(in, fileVersion) || fileVersion != version || !readValue(in, threads)) {
+    return false;
+  }
+  std::vector<TraceBuffer> loaded;
+  for (uint32_t i = 0; i < threads; ++i) {
+    uint64_t recorded, held;
+    if (!readValue(in, recorded) || !readValue(in, held) || held > recorded) return false;
+    std::vector<TraceEvent> events(held);
+    if (!in.read(reinterpret_cast<char *>(events.data()), held * sizeof(TraceEvent))) return false;
+    loaded.emplace_back(0);
+    loaded.back().assign(recorded, events);
+  }
+  buffers = std::move(loaded);
+  return true;
+}
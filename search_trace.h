@@ -0,0 +1,87 @@
+#ifndef SEARCH_TRACE_H
+#define SEARCH_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// something that happened at a node of a search, see SearchTrace
+// moves are packed as in the transposition table (see
+// TranspositionTable::encodeMove), 0 meaning no move, or a null move below
+// the root
+struct TraceEvent {
+  enum Type : uint8_t {
+    // the search of a node starts, with depth (0 in quiescence search), the
+    // window (alpha, beta) and the move leading to it
+    ENTER,
+    // the node returns score
+    EXIT,
+    // move, the count-th move searched (from 0), failed high with score
+    CUTOFF,
+    // the transposition table had the node, searched to depth, with score,
+    // flags its bound (see TranspositionTable::Bound) and move its best move
+    // count is 1 if the entry ended the node without a search
+    TT_HIT,
+  };
+  // ENTER flag
+  static const uint8_t QUIESCENCE = 1;
+  // EXIT flag: the search was stopped, score is meaningless
+  static const uint8_t STOPPED = 1;
+  uint8_t type;
+  uint8_t flags;
+  uint8_t ply;
+  int8_t depth;
+  uint16_t move;
+  uint16_t count;
+  int32_t alpha, beta, score;
+};
+
+// the last events of one thread's search in a fixed-size ring buffer
+// recording never allocates, old events are overwritten instead, so a trace
+// can stay on for whole games
+// not thread safe, every thread records into its own buffer
+class TraceBuffer {
+  std::vector<TraceEvent> events;
+  // capacity - 1, the capacity is a power of two
+  std::size_t mask;
+  // since the last clear, including overwritten events
+  uint64_t recorded;
+public:
+  // capacity is rounded up to a power of two
+  explicit TraceBuffer(std::size_t capacity);
+  // defined here so it inlines into the search
+  void record(const TraceEvent &event) {
+    events[recorded++ & mask] = event;
+  }
+  void clear();
+  uint64_t numRecorded() const;
+  // the events still held, oldest first
+  std::vector<TraceEvent> held() const;
+  // replaces the contents with events, recorded of them in total (for
+  // reading a trace file)
+  void assign(uint64_t recorded, const std::vector<TraceEvent> &events);
+};
+
+// the trace of a search, one buffer per thread
+// the file format is the magic "CTRC", a version and the number of threads
+// (32 bits each), then for each thread the number of events recorded and of
+// events held (64 bits each) followed by the held events as they are in
+// memory, oldest first, all in the byte order of the machine that wrote it
+class SearchTrace {
+  std::vector<TraceBuffer> buffers;
+public:
+  // a trace with no threads records nothing
+  SearchTrace(int threads = 0, std::size_t eventsPerThread = 0);
+  int numThreads() const;
+  TraceBuffer &thread(int index);
+  const TraceBuffer &thread(int index) const;
+  void clear();
+  // returns whether the file was written
+  bool write(const std::string &path) const;
+  // returns whether a valid trace was read, leaving the trace unchanged if
+  // not
+  bool read(const std::string &path);
+};
+
+#endif
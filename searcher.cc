@@ -0,0 +1,418 @@
+#include <algorithm>
+
+#include "move_picker.h"
+#include "piece_values.h"
+#include "score.h"
+#include "searcher.h"
+
+SharedSearch::SharedSearch(SearchLimits limits, SearchOptions options, TranspositionTable &tt,
+    StopToken stopToken, bool pondering)
+  : limits{ limits }
+  , options{ options }
+  , tt(tt)
+  , stopToken{ stopToken }
+  , start{ std::chrono::steady_clock::now() }
+  , stop{ false }
+  , nodes{ 0 }
+  , pondering{ pondering }
+{}
+
+void SharedSearch::ponderHit() {
+  start = std::chrono::steady_clock::now();
+  nodes = 0;
+  // publishes start to the main searcher, which reads it only after seeing
+  // pondering is false
+  pondering.store(false, std::memory_order_release);
+}
+
+Searcher::Searcher(SharedSearch &shared, const Board &board, MoveOrderer &orderer,
+    Evaluator &evaluator, bool isMain, std::vector<Move> rootMoves, TraceBuffer *trace)
+  : shared(shared)
+  , board{ board }
+  , orderer(orderer)
+  , evaluator(evaluator)
+  , isMain{ isMain }
+  , rootMoves{ std::move(rootMoves) }
+  , completedDepth{ 0 }
+  , bestScore{ 0 }
+  , pvTable(MoveOrderer::maxPly + 1)
+  , trace{ trace }
+  // a helper's result is never used, so it may stop at any time
+  , canStop{ !isMain }
+  , stopped{ false }
+{
+  if (evaluator.network()) this->board.setNetwork(evaluator.network());
+}
+
+bool Searcher::outOfBudget() const {
+  if (shared.pondering.load(std::memory_order_acquire)) return false;
+  const SearchLimits &limits = shared.limits;
+  if (limits.maxNodes && shared.nodes >= limits.maxNodes) return true;
+  if (limits.moveTime.count()
+      && std::chrono::steady_clock::now() - shared.start >= limits.moveTime) {
+    return true;
+  }
+  return false;
+}
+
+void Searcher::visitNode(int ply) {
+  ++stats.nodes;
+  stats.selDepth = std::max(stats.selDepth, ply);
+  shared.nodes.fetch_add(1, std::memory_order_relaxed);
+  if (stopped) return;
+  // every thread checks the token itself rather than waiting for the main
+  // searcher to notice it, so helpers stop at once even when they outnumber
+  // the cores
+  if (shared.stop.load(std::memory_order_relaxed) || shared.stopToken.stopRequested()) {
+    // the main searcher only gets here when a ponder search is abandoned or
+    // the caller stops the search
+    stopped = true;
+  } else if (isMain) {
+    // checking the clock is cheap next to Board::move, so check every node
+    if (canStop && outOfBudget()) {
+      stopped = true;
+      shared.stop = true;
+    }
+  }
+}
+
+void Searcher::updatePv(int ply, const Move &move) {
+  std::vector<Move> &line = pvTable[ply];
+  line.clear();
+  line.push_back(move);
+  const std::vector<Move> &rest = pvTable[ply + 1];
+  line.insert(line.end(), rest.begin(), rest.end());
+}
+
+void Searcher::traceEnter(int ply, int depth, int alpha, int beta) {
+  // the move that led here, the root's was played before the search
+  const Move *move = ply > 0 ? board.lastMove() : nullptr;
+  trace->record(TraceEvent{ TraceEvent::ENTER,
+    static_cast<uint8_t>(depth > 0 ? 0 : TraceEvent::QUIESCENCE),
+    static_cast<uint8_t>(ply), static_cast<int8_t>(depth),
+    TranspositionTable::encodeMove(move), 0, alpha, beta, 0 });
+}
+
+void Searcher::traceExit(int ply, int score) {
+  trace->record(TraceEvent{ TraceEvent::EXIT,
+    static_cast<uint8_t>(stopped ? TraceEvent::STOPPED : 0),
+    static_cast<uint8_t>(ply), 0, 0, 0, 0, 0, score });
+}
+
+int Searcher::negamax(int depth, int ply, int alpha, int beta, bool allowNullMove) {
+  if (depth <= 0) return quiesce(ply, alpha, beta);
+  if (!trace) return searchNode(depth, ply, alpha, beta, allowNullMove);
+  traceEnter(ply, depth, alpha, beta);
+  int score = searchNode(depth, ply, alpha, beta, allowNullMove);
+  traceExit(ply, score);
+  return score;
+}
+
+int Searcher::searchNode(int depth, int ply, int alpha, int beta, bool allowNullMove) {
+  visitNode(ply);
+  if (stopped) return 0;
+  pvTable[ply].clear();
+  // a repeated position is a draw: whoever could avoid it already had the
+  // choice the first time, and searching on would only repeat that subtree
+  if (ply > 0 && (board.isRepetition() || board.getState() == Board::FIFTY_MOVES)) return 0;
+  if (ply >= MoveOrderer::maxPly) return evaluator.evaluate(board);
+  // mate distance pruning: nothing from here beats mating on the next ply or
+  // does worse than getting mated here, if a shorter mate is already known
+  // the window is empty
+  if (ply > 0) {
+    alpha = std::max(alpha, matedIn(ply));
+    beta = std::min(beta, mateIn(ply + 1));
+    if (alpha >= beta) return alpha;
+  }
+
+  const int origAlpha = alpha;
+  TranspositionTable::Entry entry;
+  bool found = shared.tt.probe(board.getHash(), entry);
+  if (found && trace) {
+    int score = scoreFromTable(entry.score, ply);
+    bool ends = entry.depth >= depth && (entry.bound == TranspositionTable::EXACT
+      || (entry.bound == TranspositionTable::LOWER && score >= beta)
+      || (entry.bound == TranspositionTable::UPPER && score <= alpha));
+    trace->record(TraceEvent{ TraceEvent::TT_HIT, static_cast<uint8_t>(entry.bound),
+      static_cast<uint8_t>(ply), static_cast<int8_t>(entry.depth),
+      TranspositionTable::encodeMove(entry.bestMove.get()), ends, 0, 0, score });
+  }
+  if (found && entry.depth >= depth) {
+    int score = scoreFromTable(entry.score, ply);
+    switch (entry.bound) {
+    case TranspositionTable::EXACT:
+      return score;
+    case TranspositionTable::LOWER:
+      if (score >= beta) return score;
+      break;
+    case TranspositionTable::UPPER:
+      if (score <= alpha) return score;
+      break;
+    case TranspositionTable::NONE:
+      break;
+    }
+  }
+
+  if (!board.hasLegalMoves()) {
+    return board.getState() == Board::CHECKMATE ? matedIn(ply) : evaluator.evaluate(board);
+  }
+
+  bool inCheck = board.getState() == Board::CHECK;
+  if (shared.options.nullMovePruning && allowNullMove && !inCheck && depth >= 3
+      && beta < mateBound && board.hasNonPawnMaterial(board.getTurn())
+      && evaluator.evaluate(board) >= beta) {
+    // if passing still leaves us above beta after a reduced search, a real
+    // move almost certainly would too
+    // not when beta is a mate score: the reduced search proves no mate, so
+    // returning beta would store an unproven mate bound
+    const int reduction = depth > 6 ? 3 : 2;
+    board.nullMove();
+    int eval = -negamax(depth - 1 - reduction, ply + 1, -beta, -beta + 1, false);
+    board.undoNullMove();
+    if (stopped) return 0;
+    if (eval >= beta) return beta;
+  }
+
+  // the best move found by a previous search is likely best again, try it first
+  MovePicker picker(board, orderer, entry.bestMove.get(), ply);
+
+  int bestEval = -infiniteScore;
+  const Move *bestMove = nullptr;
+  int i = 0;
+  for (const Move *next = picker.next(); next; next = picker.next(), ++i) {
+    const Move &move = *next;
+    bool quiet = !MoveOrderer::isCapture(board, move);
+    board.move(move);
+    int eval;
+    if (i == 0) {
+      eval = -negamax(depth - 1, ply + 1, -beta, -alpha);
+    } else {
+      // moves this late are rarely best, check that with a cheaper search
+      int reduction = 0;
+      if (shared.options.lateMoveReductions && quiet && !inCheck && i >= 3
+          && depth >= 3 && board.getState() != Board::CHECK) {
+        reduction = i >= 6 && depth >= 5 ? 2 : 1;
+      }
+      eval = -negamax(depth - 1 - reduction, ply + 1, -alpha - 1, -alpha);
+      if (!stopped && eval > alpha && reduction) {
+        eval = -negamax(depth - 1, ply + 1, -alpha - 1, -alpha);
+      }
+      if (!stopped && eval > alpha && eval < beta) {
+        eval = -negamax(depth - 1, ply + 1, -beta, -alpha);
+      }
+    }
+    board.undo();
+    if (stopped) return 0;
+    if (eval > bestEval || !bestMove) {
+      bestEval = eval;
+      bestMove = &move;
+    }
+    if (eval > alpha && eval < beta) updatePv(ply, move);
+    alpha = std::max(alpha, bestEval);
+    if (beta <= alpha) {
+      ++stats.betaCutoffs;
+      if (i == 0) ++stats.firstMoveCutoffs;
+      if (trace) {
+        trace->record(TraceEvent{ TraceEvent::CUTOFF, 0, static_cast<uint8_t>(ply),
+          static_cast<int8_t>(depth), TranspositionTable::encodeMove(&move),
+          static_cast<uint16_t>(i), 0, 0, bestEval });
+      }
+      orderer.cutoff(board, move, ply, depth);
+      break;
+    }
+  }
+
+  TranspositionTable::Bound bound = TranspositionTable::EXACT;
+  if (bestEval <= origAlpha) {
+    bound = TranspositionTable::UPPER;
+  } else if (bestEval >= beta) {
+    bound = TranspositionTable::LOWER;
+  }
+  // a fail low says nothing about which move is best
+  shared.tt.store(board.getHash(), depth, bound, scoreToTable(bestEval, ply),
+    bound == TranspositionTable::UPPER ? nullptr : bestMove);
+  return bestEval;
+}
+
+int Searcher::quiesce(int ply, int alpha, int beta) {
+  if (!trace) return quiesceNode(ply, alpha, beta);
+  traceEnter(ply, 0, alpha, beta);
+  int score = quiesceNode(ply, alpha, beta);
+  traceExit(ply, score);
+  return score;
+}
+
+int Searcher::quiesceNode(int ply, int alpha, int beta) {
+  // a capture that can't bring the score back up to alpha even with this much
+  // positional compensation is not worth searching
+  const int deltaMargin = 200;
+
+  visitNode(ply);
+  ++stats.qnodes;
+  if (stopped) return 0;
+  // the principal variation ends where quiescence search starts
+  pvTable[ply].clear();
+  // a check evasion can repeat a position too
+  if (board.isRepetition() || board.getState() == Board::FIFTY_MOVES) return 0;
+
+  if (!board.hasLegalMoves() && board.getState() == Board::CHECKMATE) return matedIn(ply);
+  if (!board.hasLegalMoves() || ply >= MoveOrderer::maxPly) return evaluator.evaluate(board);
+
+  bool inCheck = board.getState() == Board::CHECK;
+  int standPat = -infiniteScore;
+  if (!inCheck) {
+    // the side to move can usually do at least as well as the static
+    // evaluation by not capturing, unless it is in check
+    standPat = evaluator.evaluate(board);
+    if (standPat >= beta) return standPat;
+    alpha = std::max(alpha, standPat);
+  }
+  // every move is searched when in check, there is no standing pat
+  MovePicker picker(board, orderer, nullptr, ply, !inCheck);
+
+  int bestEval = standPat;
+  for (const Move *next = picker.next(); next; next = picker.next()) {
+    const Move &move = *next;
+    if (!inCheck) {
+      const Piece *victim = board.at(move.to.row, move.to.col);
+      // a capture to an empty square is en passant
+      int gain = victim ? pieceValue(victim->type) : pieceValue(PAWN);
+      if (move.promoteTo != PAWN) gain += pieceValue(move.promoteTo) - pieceValue(PAWN);
+      if (standPat + gain + deltaMargin <= alpha) continue;
+      if (shared.options.seePruning && MoveOrderer::staticExchange(board, move) < 0) continue;
+    }
+    board.move(move);
+    int eval = -quiesce(ply + 1, -beta, -alpha);
+    board.undo();
+    if (stopped) return 0;
+    bestEval = std::max(bestEval, eval);
+    alpha = std::max(alpha, bestEval);
+    if (beta <= alpha) break;
+  }
+  return bestEval;
+}
+
+int Searcher::searchRoot(int depth, int alpha, int beta) {
+  const int infinity = infiniteScore;
+  size_t bestIndex = 0;
+  int bestPoints = -infinity;
+  std::vector<Move> line;
+  if (trace) traceEnter(0, depth, alpha, beta);
+  for (size_t i = 0; i < rootMoves.size(); ++i) {
+    board.move(rootMoves[i]);
+    int points;
+    if (i == 0) {
+      points = -negamax(depth - 1, 1, -beta, -alpha);
+    } else {
+      points = -negamax(depth - 1, 1, -alpha - 1, -alpha);
+      if (!stopped && points > alpha && points < beta) {
+        points = -negamax(depth - 1, 1, -beta, -alpha);
+      }
+    }
+    board.undo();
+    if (stopped) {
+      if (trace) traceExit(0, 0);
+      return 0;
+    }
+    if (points > bestPoints) {
+      bestIndex = i;
+      bestPoints = points;
+    }
+    if (points > alpha) {
+      alpha = points;
+      line.assign(1, rootMoves[i]);
+      line.insert(line.end(), pvTable[1].begin(), pvTable[1].end());
+    }
+    if (points >= beta) {
+      if (trace) {
+        trace->record(TraceEvent{ TraceEvent::CUTOFF, 0, 0, static_cast<int8_t>(depth),
+          TranspositionTable::encodeMove(&rootMoves[i]), static_cast<uint16_t>(i), 0, 0, points });
+      }
+      break;
+    }
+  }
+  // a fail low says nothing about which move is best
+  if (!line.empty()) {
+    // search the best move first in the next iteration
+    std::rotate(rootMoves.begin(), rootMoves.begin() + bestIndex,
+      rootMoves.begin() + bestIndex + 1);
+    pv = std::move(line);
+  }
+  if (trace) traceExit(0, bestPoints);
+  return bestPoints;
+}
+
+void Searcher::run(int startDepth, int expectedScore) {
+  const int infinity = infiniteScore;
+  // in centipawns, half a pawn
+  const int initialWindow = 50;
+  bestScore = expectedScore;
+  // the first iteration of a warm start can take as long as the whole earlier
+  // search did, if the table lost its subtree, so it must be able to stop
+  if (startDepth > 1) canStop = true;
+  // a search restricted to some root moves (see ComputerPlayer4::analyse)
+  // doesn't find the value of the position
+  bool allMoves = rootMoves.size() == board.legalMoves().size();
+  auto iterationStart = std::chrono::steady_clock::now();
+  for (int depth = startDepth; depth <= shared.limits.maxDepth; ++depth) {
+    int alpha = -infinity, beta = infinity;
+    int window = initialWindow;
+    // the first iterations are too cheap and unstable to be worth it
+    if (depth >= 3) {
+      alpha = std::max(-infinity, bestScore - window);
+      beta = std::min(infinity, bestScore + window);
+    }
+    int score;
+    while (true) {
+      score = searchRoot(depth, alpha, beta);
+      if (stopped) break;
+      // widen the window on the side the score fell out of
+      window *= 4;
+      if (score <= alpha && alpha > -infinity) {
+        alpha = window > 800 ? -infinity : std::max(-infinity, bestScore - window);
+      } else if (score >= beta && beta < infinity) {
+        beta = window > 800 ? infinity : std::min(infinity, bestScore + window);
+      } else {
+        break;
+      }
+    }
+    // an interrupted iteration is discarded, rootMoves still holds the best
+    // move of the last completed one first (or a move that beat it)
+    if (stopped) break;
+    completedDepth = depth;
+    stats.depth = depth;
+    auto now = std::chrono::steady_clock::now();
+    stats.iterationMillis.push_back(
+      std::chrono::duration<double, std::milli>(now - iterationStart).count());
+    iterationStart = now;
+    bestScore = score;
+    canStop = true;
+    if (isMain && allMoves) {
+      shared.tt.store(board.getHash(), depth, TranspositionTable::EXACT, scoreToTable(score, 0), &rootMoves.front());
+    }
+    // iterative deepening finds the shortest forced mate first, more depth
+    // won't change it
+    if (isMateScore(bestScore)) break;
+    if (shared.stop || (isMain && outOfBudget())) break;
+  }
+}
+
+const Move &Searcher::bestMove() const {
+  return rootMoves.front();
+}
+
+int Searcher::score() const {
+  return bestScore;
+}
+
+int Searcher::depth() const {
+  return completedDepth;
+}
+
+const std::vector<Move> &Searcher::principalVariation() const {
+  return pv;
+}
+
+const SearchStats &Searcher::statistics() const {
+  return stats;
+}
@@ -0,0 +1,129 @@
+#ifndef SEARCHER_H
+#define SEARCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "board.h"
+#include "evaluator.h"
+#include "move_orderer.h"
+#include "search_limits.h"
+#include "search_options.h"
+#include "search_stats.h"
+#include "search_trace.h"
+#include "stop_token.h"
+#include "transposition_table.h"
+
+// state shared by all the threads searching the same position
+struct SharedSearch {
+  const SearchLimits limits;
+  const SearchOptions options;
+  TranspositionTable &tt;
+  // lets the caller stop the search from another thread
+  const StopToken stopToken;
+  // only written by ponderHit
+  std::chrono::steady_clock::time_point start;
+  // set when every thread should stop searching
+  std::atomic<bool> stop;
+  // nodes searched by all threads
+  std::atomic<uint64_t> nodes;
+  // the limits don't apply while pondering, the search only ends when stopped
+  // or when it reaches the maximum depth
+  std::atomic<bool> pondering;
+  SharedSearch(SearchLimits limits, SearchOptions options, TranspositionTable &tt,
+    StopToken stopToken = StopToken(), bool pondering = false);
+  // the opponent played the predicted move: the limits apply from now on
+  // may be called while the search is running
+  void ponderHit();
+};
+
+// alpha-beta search of a position on a single thread
+// several searchers can search the same position in parallel, sharing the
+// transposition table: each speeds up the others by filling the table with
+// positions they will reach later (lazy SMP)
+// the main searcher enforces the search limits and the stop token and ends the
+// search for all, its result is the result of the search, the others (helpers)
+// only exist to fill the table
+class Searcher {
+  SharedSearch &shared;
+  // searched on directly, so every thread needs its own copy
+  Board board;
+  MoveOrderer &orderer;
+  Evaluator &evaluator;
+  bool isMain;
+  // best first after every completed iteration
+  std::vector<Move> rootMoves;
+  int completedDepth;
+  int bestScore;
+  // triangular table, pvTable[ply] is the best line found from the node at
+  // ply currently being searched
+  std::vector<std::vector<Move>> pvTable;
+  // principal variation of the last completed iteration
+  std::vector<Move> pv;
+  // counts of this thread, the table and time are measured by the caller
+  SearchStats stats;
+  // null unless tracing
+  TraceBuffer *trace;
+  // set once the first iteration completes, or from the start of a warm
+  // start (see run), so there is always a move to play
+  bool canStop;
+  // set when the search should end, the search then unwinds without storing
+  // results
+  bool stopped;
+  bool outOfBudget() const;
+  // counts a node at ply and checks whether the search should stop
+  void visitNode(int ply);
+  // sets the line from ply to move followed by the line from ply + 1
+  void updatePv(int ply, const Move &move);
+  // principal variation search: negamax with alpha-beta pruning where every
+  // move after the first is only searched with a null window, to prove it is
+  // no better than alpha, and searched again with the full window if it is
+  // returns points from the perspective of the player whose turn it is
+  // ply is the distance from the root
+  // allowNullMove is false right after a null move, so two never follow each
+  // other
+  // if the search is stopped the return value is meaningless
+  int negamax(int depth, int ply, int alpha, int beta, bool allowNullMove = true);
+  // searches captures (or all moves when in check) until the position is
+  // quiet, so leaf positions are not evaluated in the middle of an exchange
+  int quiesce(int ply, int alpha, int beta);
+  // the bodies of negamax (for depth > 0) and quiesce, which trace the node
+  // around them
+  int searchNode(int depth, int ply, int alpha, int beta, bool allowNullMove);
+  int quiesceNode(int ply, int alpha, int beta);
+  void traceEnter(int ply, int depth, int alpha, int beta);
+  void traceExit(int ply, int score);
+  // searches every root move to depth within the window (alpha, beta),
+  // moving the best one to the front unless all moves failed low
+  // returns the best score
+  int searchRoot(int depth, int alpha, int beta);
+public:
+  // rootMoves must be the legal moves of board, in the order to search them
+  // first
+  // the search is recorded into trace unless it is null
+  Searcher(SharedSearch &shared, const Board &board, MoveOrderer &orderer,
+    Evaluator &evaluator, bool isMain, std::vector<Move> rootMoves, TraceBuffer *trace = nullptr);
+  // searches with iterative deepening from startDepth (in plies) until the
+  // search limits are reached (main searcher) or the search is stopped
+  // each iteration first searches a narrow (aspiration) window around the
+  // score of the previous one (expectedScore for the first), widening it if
+  // the score falls outside
+  // the main searcher stores the result of every iteration in the
+  // transposition table, so a later search of the same position can start
+  // from it
+  // such a warm start (startDepth above 1) must put the best move of the
+  // earlier search first in rootMoves: the search may then stop before its
+  // first iteration completes, playing that move
+  void run(int startDepth, int expectedScore = 0);
+  // best move of the deepest completed iteration
+  const Move &bestMove() const;
+  int score() const;
+  int depth() const;
+  // the expected line of play from the root, starting with bestMove()
+  const std::vector<Move> &principalVariation() const;
+  const SearchStats &statistics() const;
+};
+
+#endif
@@ -0,0 +1,327 @@
+#include <chrono>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include "board.h"
+#include "computer_player_1.h"
+#include "computer_player_2.h"
+#include "computer_player_3.h"
+#include "computer_player_4.h"
+#include "computer_player_5.h"
+#include "graphic_display.h"
+#include "game.h"
+#include "human_player.h"
+#include "text_display.h"
+
+#include "session.h"
+
+// engine settings changed by the option command, they apply to the computer
+// players of every later game
+struct EngineSettings {
+  SearchLimits limits;
+  SearchOptions options;
+  MctsOptions mctsOptions;
+};
+
+// beyond these the players can't be created, or not in any sensible time
+const long long maxThreads = 256;
+const long long maxHashMegabytes = 4096;
+
+// option <name> [value], see runSession
+// returns whether the option is valid
+bool setOption(EngineSettings &settings, std::istream &in) {
+  std::string name;
+  if (!(in >> name)) return false;
+  if (name == "depth" || name == "nodes" || name == "movetime"
+      || name == "threads" || name == "hash") {
+    long long value;
+    if (!(in >> value) || value < 0) return false;
+    if (name == "depth") {
+      if (value < 1) return false;
+      settings.limits.maxDepth = value;
+    } else if (name == "nodes") {
+      settings.limits.maxNodes = value;
+    } else if (name == "movetime") {
+      settings.limits.moveTime = std::chrono::milliseconds(value);
+    } else if (name == "threads") {
+      if (value < 1 || value > maxThreads) return false;
+      settings.options.threads = value;
+      settings.mctsOptions.threads = value;
+    } else { // name == "hash"
+      if (value < 1 || value > maxHashMegabytes) return false;
+      settings.options.hashMegabytes = value;
+    }
+    return true;
+  }
+  if (name == "stats") {
+    std::string value;
+    if (!(in >> value) || (value != "on" && value != "off")) return false;
+    settings.options.reportStats = value == "on";
+    return true;
+  }
+  // no file turns the option off
+  std::string file;
+  in >> file;
+  if (name == "book") {
+    settings.options.bookFile = file;
+  } else if (name == "network") {
+    settings.options.networkFile = file;
+  } else if (name == "trace") {
+    settings.options.traceFile = file;
+    if (file.empty()) {
+      settings.options.traceEvents = 0;
+    } else if (!settings.options.traceEvents) {
+      settings.options.traceEvents = 1 << 16;
+    }
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// human players read their commands from input and report to output
+// opponentString is needed since engines only think on their opponent's time
+// if it is a human's: against another engine, they would steal its CPU
+// throws std::logic_error if an engine can't load a file of settings
+bool makePlayer(const std::string &playerString, const std::string &opponentString,
+    const EngineSettings &settings, std::unique_ptr<Player> &player,
+    std::istream &input, std::ostream &output) {
+  if (playerString[0] == 'h') {
+    player = std::make_unique<HumanPlayer>(input, output);
+  } else if (playerString[0] == 'c') {
+    switch (playerString.back()) {
+    case '1':
+      player = std::make_unique<ComputerPlayer1>();
+      break;
+    case '2':
+      player = std::make_unique<ComputerPlayer2>();
+      break;
+    case '3':
+      player = std::make_unique<ComputerPlayer3>();
+      break;
+    case '4': {
+      SearchOptions options = settings.options;
+      options.ponder = opponentString[0] == 'h';
+      player = std::make_unique<ComputerPlayer4>(settings.limits, options);
+    } break;
+    case '5':
+      player = std::make_unique<ComputerPlayer5>(settings.limits, settings.mctsOptions);
+      break;
+    default:
+      return false;
+    }
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::istream &operator>>(std::istream &in, Piece &piece) {
+  char c;
+  if (!(in >> c))return in;
+  Colour colour = WHITE;
+  if (c >= 'a' && c <= 'z') {
+    colour = BLACK;
+    c = c - 'a' + 'A';
+  }
+  PieceType type;
+  switch (c) {
+  case 'P':
+    type = PAWN;
+    break;
+  case 'R':
+    type = ROOK;
+    break;
+  case 'N':
+    type = KNIGHT;
+    break;
+  case 'B':
+    type = BISHOP;
+    break;
+  case 'Q':
+    type = QUEEN;
+    break;
+  case 'K':
+    type = KING;
+    break;
+  default:
+    in.setstate(std::istream::failbit);
+    return in;
+    break;
+  }
+  piece.colour = colour;
+  piece.type = type;
+  return in;
+}
+
+void setup(Board &board, std::istream &in, std::ostream &out) {
+  std::array<std::array<std::unique_ptr<Piece>, 8>, 8> pieces;
+  Colour turn = WHITE;
+  std::array<int, 2> numKings{ 0, 0 };
+  std::string line;
+  while(getline(in, line)) {
+    std::istringstream iss(std::move(line));
+    std::string cmd;
+    iss >> cmd;
+    bool validCommand = false;
+    switch (cmd[0]) {
+      case '+': {
+        Piece piece(BLACK, PAWN);
+        Coord coord(0, 0);
+        if (iss >> piece >> coord) {
+          const Piece *origPiece = pieces[coord.row][coord.col].get();
+          if (origPiece && origPiece->type == KING) {
+            --numKings[origPiece->colour];
+          }
+          if (piece.type == KING) {
+            ++numKings[piece.colour];
+          }
+          pieces[coord.row][coord.col] = std::make_unique<Piece>(piece);
+          validCommand = true;
+        }
+      } break;
+      case '-': {
+        Coord coord(0, 0);
+        if (iss >> coord) {
+          const Piece *piece = pieces[coord.row][coord.col].get();
+          if (piece && piece->type == KING) {
+            --numKings[piece->colour];
+          }
+          pieces[coord.row][coord.col].reset();
+          validCommand = true;
+        }
+      } break;
+      case '=': {
+        std::string colour;
+        if (iss >> colour) {
+          if (colour == "white") {
+            validCommand = true;
+            turn = WHITE;
+          } else if (colour == "black") {
+            validCommand = true;
+            turn = BLACK;
+          }
+        }
+      } break;
+      case 'd': { // done
+        validCommand = true;
+        if (numKings[WHITE] != 1 || numKings[BLACK] != 1) {
+          out << "Must have exactly one king of each colour." << std::endl;
+          continue;
+        }
+        bool pawnsValid = true;
+        for (int col = 0; col < 8; ++col) {
+          const Piece *piece = pieces[7][col].get();
+          if (piece && piece->type == PAWN) {
+            pawnsValid = false;
+            break;
+          }
+          piece = pieces[0][col].get();
+          if (piece && piece->type == PAWN) {
+            pawnsValid = false;
+            break;
+          }
+        }
+        if (!pawnsValid) {
+          out << "Cannot have pawns in the first or last row." << std::endl;
+          continue;
+        }
+        Board tmpBoard(pieces, turn);
+        if (tmpBoard.getState() == Board::CHECK || tmpBoard.getState() == Board::CHECKMATE) {
+          out << "Kings must not be in check." << std::endl;
+          continue;
+        }
+        board = tmpBoard;
+        out << "Setup complete." << std::endl;
+        return;
+      };
+    }
+    if (!validCommand) {
+      out << "Invalid setup command." << std::endl;
+    }
+  }
+}
+
+void runSession(std::istream &in, std::ostream &out, bool graphical) {
+  Board board;
+  EngineSettings settings;
+  std::string line;
+  std::array<int, 2> halfPoints{ 0, 0 };
+  while (getline(in, line)) {
+    std::istringstream iss(std::move(line));
+    std::string cmd;
+    iss >> cmd;
+    bool validCommand = false;
+    switch (cmd[0]) {
+      case 'g': {
+        std::string whiteString, blackString;
+        std::unique_ptr<Player> white, black;
+        bool madePlayers;
+        try {
+          madePlayers = iss >> whiteString >> blackString
+            && makePlayer(whiteString, blackString, settings, white, in, out)
+            && makePlayer(blackString, whiteString, settings, black, in, out);
+        } catch (std::logic_error &e) {
+          out << e.what() << std::endl;
+          validCommand = true;
+          break;
+        } catch (std::bad_alloc &) {
+          // the options ask for more memory or threads than there are
+          out << "Invalid option: the players can't be created." << std::endl;
+          validCommand = true;
+          break;
+        } catch (std::system_error &) {
+          out << "Invalid option: the players can't be created." << std::endl;
+          validCommand = true;
+          break;
+        }
+        if (madePlayers) {
+          validCommand = true;
+          std::vector<std::unique_ptr<ChessDisplay>> displays;
+          displays.push_back(std::make_unique<TextDisplay>(out));
+          if (graphical) displays.push_back(std::make_unique<GraphicDisplay>());
+          Game game(std::move(board), std::move(white), std::move(black), std::move(displays), out);
+          switch (game.run()) {
+          case Game::CHECKMATE_WHITE_WINS:
+          case Game::BLACK_RESIGNED:
+            halfPoints[WHITE] += 2;
+            break;
+          case Game::CHECKMATE_BLACK_WINS:
+          case Game::WHITE_RESIGNED:
+            halfPoints[BLACK] += 2;
+            break;
+          case Game::STALEMATE:
+          case Game::DRAW:
+            ++halfPoints[WHITE];
+            ++halfPoints[BLACK];
+            break;
+          }
+          board = Board();
+        }
+      } break;
+      case 's': {
+        validCommand = true;
+        setup(board, in, out);
+      } break;
+      case 'o': {
+        validCommand = true;
+        if (!setOption(settings, iss)) out << "Invalid option." << std::endl;
+      } break;
+    }
+    if (!validCommand) {
+      out << "Invalid command." << std::endl;
+    }
+  }
+  std::array<int, 2> fullPoints{ halfPoints[BLACK] / 2, halfPoints[WHITE] / 2 };
+  out << "Final Score:" << std::endl;
+  out << "White: " << fullPoints[WHITE];
+  if (halfPoints[WHITE] % 2) out << " 1/2";
+  out << std::endl;
+  out << "Black: " << fullPoints[BLACK];
+  if (halfPoints[BLACK] % 2) out << " 1/2";
+  out << std::endl;
+}
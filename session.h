@@ -0,0 +1,19 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <iostream>
+
+// runs the chess command interpreter (game, setup, option) until in is
+// exhausted, then prints the final score
+// option <name> [value] configures the computer players of later games:
+//   depth <plies>, nodes <count>, movetime <milliseconds> (0 for no limit)
+//   bound each move (see SearchLimits), threads <count> (up to 256) and
+//   hash <megabytes> (up to 4096) size the search, stats on|off prints the
+//   work of each search and game (see SearchOptions::reportStats), and book,
+//   network and trace name the files of SearchOptions (no file turns them
+//   off)
+// if graphical is false no X window is opened, so sessions can run headless
+// and several sessions can run side by side in one process
+void runSession(std::istream &in, std::ostream &out, bool graphical);
+
+#endif
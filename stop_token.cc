@@ -0,0 +1,15 @@
+#include "stop_token.h"
+
+StopToken::StopToken() : flag{ std::make_shared<std::atomic<bool>>(false) } {}
+
+void StopToken::requestStop() {
+  flag->store(true, std::memory_order_relaxed);
+}
+
+void StopToken::reset() {
+  flag->store(false, std::memory_order_relaxed);
+}
+
+bool StopToken::stopRequested() const {
+  return flag->load(std::memory_order_relaxed);
+}
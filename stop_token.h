@@ -0,0 +1,23 @@
+#ifndef STOP_TOKEN_H
+#define STOP_TOKEN_H
+
+#include <atomic>
+#include <memory>
+
+// lets one thread ask an engine searching on another to stop early
+// copies share the same flag: the caller keeps a copy and passes another to
+// the engine, requesting a stop on its copy makes the engine return the best
+// move it has found so far
+// a requested stop stays requested (so later searches return at once) until
+// reset
+class StopToken {
+  std::shared_ptr<std::atomic<bool>> flag;
+public:
+  StopToken();
+  void requestStop();
+  void reset();
+  // cheap enough to call at every node
+  bool stopRequested() const;
+};
+
+#endif
@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "board_harness.h"
+#include "session.h"
+
+// runs every script in-process and in parallel, comparing what it prints with
+// the file <script>.expected next to it
+//
+// usage: runtests [-u] [-j threads] [script or directory...]
+//   -u  (re)writes the expected output of every script from its actual output
+//   -j  number of worker threads, defaults to the number of cores
+// with no paths, runs input.in, take.in and everything under tests/
+//
+// a script whose first command is a game, setup or option command is run through the
+// chess command interpreter with a headless display, anything else is run
+// through the board harness (see board_harness.h)
+
+const std::string expectedSuffix = ".expected";
+
+struct Script {
+  std::string path;
+  std::string output;
+  std::string expected;
+  bool hasExpected = false;
+  double millis = 0;
+};
+
+bool endsWith(const std::string &s, const std::string &suffix) {
+  return s.size() >= suffix.size()
+    && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool readFile(const std::string &path, std::string &contents) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return false;
+  std::ostringstream oss;
+  oss << file.rdbuf();
+  contents = oss.str();
+  return true;
+}
+
+void collect(const std::string &path, std::vector<std::string> &paths) {
+  struct stat info;
+  if (stat(path.c_str(), &info) != 0) {
+    std::cerr << "runtests: cannot open " << path << std::endl;
+    return;
+  }
+  if (!S_ISDIR(info.st_mode)) {
+    paths.push_back(path);
+    return;
+  }
+  DIR *dir = opendir(path.c_str());
+  if (!dir) return;
+  std::vector<std::string> entries;
+  while (dirent *entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    // inputs of other tests (see check-bookbuild in the Makefile) aren't
+    // scripts
+    if (name.empty() || name[0] == '.' || endsWith(name, expectedSuffix)
+        || endsWith(name, ".pgn")) continue;
+    entries.push_back(path + "/" + name);
+  }
+  closedir(dir);
+  // directory order is arbitrary, keep the report stable
+  std::sort(entries.begin(), entries.end());
+  for (const std::string &entry : entries) collect(entry, paths);
+}
+
+bool isSessionScript(const std::string &contents) {
+  std::istringstream iss(contents);
+  std::string cmd;
+  if (!(iss >> cmd)) return false;
+  return cmd[0] == 'g' || cmd[0] == 's' || cmd[0] == 'o';
+}
+
+void run(Script &script) {
+  std::string contents;
+  if (!readFile(script.path, contents)) {
+    script.output = "runtests: cannot read script\n";
+    return;
+  }
+  script.hasExpected = readFile(script.path + expectedSuffix, script.expected);
+  std::istringstream in(contents);
+  std::ostringstream out;
+  auto start = std::chrono::steady_clock::now();
+  if (isSessionScript(contents)) {
+    runSession(in, out, false);
+  } else {
+    runBoardHarness(in, out);
+  }
+  auto end = std::chrono::steady_clock::now();
+  script.millis = std::chrono::duration<double, std::milli>(end - start).count();
+  script.output = out.str();
+}
+
+// prints the first line where actual and expected differ
+void printDiff(const std::string &actual, const std::string &expected) {
+  std::istringstream actualStream(actual), expectedStream(expected);
+  std::string actualLine, expectedLine;
+  for (int line = 1; ; ++line) {
+    bool hasActual = static_cast<bool>(getline(actualStream, actualLine));
+    bool hasExpected = static_cast<bool>(getline(expectedStream, expectedLine));
+    if (!hasActual && !hasExpected) return;
+    if (hasActual != hasExpected || actualLine != expectedLine) {
+      std::cout << "    line " << line << ":" << std::endl;
+      std::cout << "    expected: " << (hasExpected ? expectedLine : "<end of output>") << std::endl;
+      std::cout << "    actual:   " << (hasActual ? actualLine : "<end of output>") << std::endl;
+      return;
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  bool update = false;
+  unsigned numThreads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::string> paths;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "-u") == 0) {
+      update = true;
+    } else if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+      numThreads = std::max(1, std::atoi(argv[++i]));
+    } else {
+      collect(argv[i], paths);
+    }
+  }
+  if (argc == 1 || paths.empty()) {
+    collect("input.in", paths);
+    collect("take.in", paths);
+    collect("tests", paths);
+  }
+
+  std::vector<Script> scripts(paths.size());
+  for (size_t i = 0; i < paths.size(); ++i) scripts[i].path = paths[i];
+
+  auto start = std::chrono::steady_clock::now();
+  std::atomic<size_t> next{ 0 };
+  std::vector<std::thread> workers;
+  numThreads = std::min<unsigned>(numThreads, std::max<size_t>(1, scripts.size()));
+  for (unsigned i = 0; i < numThreads; ++i) {
+    workers.emplace_back([&scripts, &next] {
+      for (size_t j = next++; j < scripts.size(); j = next++) run(scripts[j]);
+    });
+  }
+  for (std::thread &worker : workers) worker.join();
+  auto end = std::chrono::steady_clock::now();
+
+  int passed = 0, failed = 0, missing = 0;
+  double totalMillis = 0;
+  std::cout << std::fixed << std::setprecision(2);
+  for (Script &script : scripts) {
+    totalMillis += script.millis;
+    std::string result;
+    if (update) {
+      std::ofstream file(script.path + expectedSuffix, std::ios::binary);
+      file << script.output;
+      result = "UPDATED";
+      ++passed;
+    } else if (!script.hasExpected) {
+      result = "MISSING";
+      ++missing;
+    } else if (script.output == script.expected) {
+      result = "PASS";
+      ++passed;
+    } else {
+      result = "FAIL";
+      ++failed;
+    }
+    std::cout << std::left << std::setw(8) << result
+      << std::right << std::setw(10) << script.millis << " ms  "
+      << script.path << std::endl;
+    if (result == "FAIL") printDiff(script.output, script.expected);
+  }
+
+  double wallMillis = std::chrono::duration<double, std::milli>(end - start).count();
+  std::cout << passed << " passed, " << failed << " failed, " << missing
+    << " missing expected output (" << scripts.size() << " scripts, "
+    << numThreads << " threads, " << totalMillis << " ms total, "
+    << wallMillis << " ms wall)" << std::endl;
+  return failed || missing ? 1 : 0;
+}
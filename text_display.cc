@@ -5,7 +5,7 @@
 
 #include "text_display.h"
 
-TextDisplay::TextDisplay() {}
+TextDisplay::TextDisplay(std::ostream &out) : out{ out } {}
 
 std::ostream &operator<<(std::ostream &out, Piece piece) {
   char c;
@@ -37,21 +37,21 @@ std::ostream &operator<<(std::ostream &out, Piece piece) {
 
 void TextDisplay::display(const Board &board) {
   for (int row = 7; row >=0; --row) {
-    std::cout << row + 1 << " ";
+    out << row + 1 << " ";
     for (int col = 0; col < 8; ++col) {
       const Piece *piece = board.at(row, col);
       if (piece) {
-        std::cout << *piece;
+        out << *piece;
       } else {
         if ((row + col) % 2) {
-          std::cout << ' ';
+          out << ' ';
         } else {
-          std::cout << '_';
+          out << '_';
         }
       }
     }
-    std::cout << std::endl;
+    out << std::endl;
   }
-  std::cout << std::endl;
-  std::cout << "  abcdefgh" << std::endl;
+  out << std::endl;
+  out << "  abcdefgh" << std::endl;
 }
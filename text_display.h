@@ -1,13 +1,16 @@
 #ifndef TEXT_DISPLAY_H
 #define TEXT_DISPLAY_H
 
+#include <iostream>
+
 #include "chess_display.h"
 
 class Board;
 
 class TextDisplay: public ChessDisplay {
+  std::ostream &out;
 public:
-  TextDisplay();
+  TextDisplay(std::ostream &out = std::cout);
   void display(const Board & board) override;
 };
 
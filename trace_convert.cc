@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "search_trace.h"
+
+// converts a search trace (see SearchTrace) to text
+//
+// usage: trace_convert [-t [plies]] trace
+//   by default prints the folded stacks format of flame graph tools: a line
+//   per path of moves from the root with the number of nodes searched there,
+//   so a flame graph shows where the nodes went
+//   -t  prints the tree of nodes instead, down to plies below the root (all
+//       by default), one node per line with its depth, window and result
+//       an argument after -t is its plies if it is all digits, and -t may come
+//       before or after the trace
+//
+// the trace only holds each thread's last events, so the oldest nodes may be
+// missing their ancestors, which are shown as ?
+
+struct Node {
+  std::string name;
+  TraceEvent enter;
+  // the node's EXIT, CUTOFF and TT_HIT events if held
+  bool exited = false, stopped = false, cutoff = false, ttHit = false;
+  int score = 0;
+  int cutoffIndex = 0;
+  std::vector<size_t> children;
+};
+
+std::string moveName(uint16_t bits, int ply) {
+  if (!bits) return ply == 0 ? "root" : "null";
+  int from = bits & 0x3f, to = (bits >> 6) & 0x3f;
+  std::string name{ char('a' + from % 8), char('1' + from / 8), char('a' + to % 8), char('1' + to / 8) };
+  // see PieceType
+  const char promotions[] = "prnbqk";
+  int promoteTo = bits >> 12;
+  if (promoteTo > 0 && promoteTo < 6) name += promotions[promoteTo];
+  return name;
+}
+
+// rebuilds the tree of one thread's events, nodes[0] is a made up root above
+// the roots of all searches (one per iteration and aspiration window)
+std::vector<Node> buildTree(const std::vector<TraceEvent> &events) {
+  std::vector<Node> nodes(1);
+  nodes[0].name = "?";
+  nodes[0].enter.ply = 0;
+  // path[i] is the node at ply i - 1 being searched
+  std::vector<size_t> path{ 0 };
+  for (const TraceEvent &event : events) {
+    switch (event.type) {
+    case TraceEvent::ENTER: {
+      // nodes whose EXIT was lost (the search was cut off) end here, ancestors
+      // that were overwritten are made up
+      path.resize(std::min<size_t>(path.size(), event.ply + 1));
+      while (path.size() < static_cast<size_t>(event.ply) + 1) {
+        Node missing;
+        missing.name = "?";
+        missing.enter = event;
+        missing.enter.ply = path.size() - 1;
+        nodes.push_back(missing);
+        nodes[path.back()].children.push_back(nodes.size() - 1);
+        path.push_back(nodes.size() - 1);
+      }
+      Node node;
+      node.name = moveName(event.move, event.ply);
+      node.enter = event;
+      nodes.push_back(node);
+      nodes[path.back()].children.push_back(nodes.size() - 1);
+      path.push_back(nodes.size() - 1);
+    } break;
+    case TraceEvent::EXIT:
+      if (path.size() == static_cast<size_t>(event.ply) + 2) {
+        Node &node = nodes[path.back()];
+        node.exited = true;
+        node.stopped = event.flags & TraceEvent::STOPPED;
+        node.score = event.score;
+        path.pop_back();
+      }
+      break;
+    case TraceEvent::CUTOFF:
+      if (path.size() == static_cast<size_t>(event.ply) + 2) {
+        nodes[path.back()].cutoff = true;
+        nodes[path.back()].cutoffIndex = event.count;
+      }
+      break;
+    case TraceEvent::TT_HIT:
+      if (path.size() == static_cast<size_t>(event.ply) + 2) nodes[path.back()].ttHit = true;
+      break;
+    }
+  }
+  return nodes;
+}
+
+void printFolded(const std::vector<Node> &nodes, size_t index, const std::string &prefix,
+    std::map<std::string, uint64_t> &counts) {
+  const Node &node = nodes[index];
+  std::string path = prefix + ";" + node.name;
+  if (index != 0) ++counts[path];
+  for (size_t child : node.children) printFolded(nodes, child, path, counts);
+}
+
+void printTree(const std::vector<Node> &nodes, size_t index, int indent, int maxPlies) {
+  const Node &node = nodes[index];
+  if (index != 0) {
+    std::cout << std::string(2 * indent, ' ') << node.name;
+    if (node.name != "?") {
+      if (node.enter.flags & TraceEvent::QUIESCENCE) {
+        std::cout << " q";
+      } else {
+        std::cout << " d" << static_cast<int>(node.enter.depth);
+      }
+      std::cout << " (" << node.enter.alpha << ", " << node.enter.beta << ")";
+      if (node.ttHit) std::cout << " tt";
+      if (node.cutoff) std::cout << " cutoff #" << node.cutoffIndex;
+      if (node.stopped) {
+        std::cout << " stopped";
+      } else if (node.exited) {
+        std::cout << " = " << node.score;
+      }
+    }
+    std::cout << std::endl;
+  }
+  if (indent >= maxPlies) return;
+  for (size_t child : node.children) printTree(nodes, child, indent + 1, maxPlies);
+}
+
+// whether s is all digits, so an argument after -t is its plies rather than
+// the trace
+bool isNumber(const char *s) {
+  if (!*s) return false;
+  for (; *s; ++s) {
+    if (!std::isdigit(static_cast<unsigned char>(*s))) return false;
+  }
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  bool tree = false;
+  int maxPlies = 1 << 30;
+  std::string path;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "-t") == 0) {
+      tree = true;
+      if (i + 1 < argc && isNumber(argv[i + 1])) maxPlies = std::atoi(argv[++i]);
+    } else {
+      path = argv[i];
+    }
+  }
+  SearchTrace trace;
+  if (path.empty() || !trace.read(path)) {
+    std::cerr << "usage: trace_convert [-t [plies]] trace" << std::endl;
+    return 1;
+  }
+  for (int thread = 0; thread < trace.numThreads(); ++thread) {
+    std::vector<Node> nodes = buildTree(trace.thread(thread).held());
+    std::string name = "thread" + std::to_string(thread);
+    if (tree) {
+      std::cout << name << ": " << trace.thread(thread).numRecorded() << " events" << std::endl;
+      printTree(nodes, 0, -1, maxPlies);
+    } else {
+      std::map<std::string, uint64_t> counts;
+      printFolded(nodes, 0, name, counts);
+      for (const auto &count : counts) {
+        // drop the made up top node
+        std::string stack = count.first;
+        stack.erase(name.size(), 2);
+        std::cout << stack << " " << count.second << std::endl;
+      }
+    }
+  }
+}
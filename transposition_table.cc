@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#include "transposition_table.h"
+
+TranspositionTable::Entry::Entry() : depth{ 0 }, bound{ NONE }, score{ 0 } {}
+
+void TranspositionTable::FreeBuckets::operator()(Bucket *buckets) const {
+  // buckets hold only atomic integers, there is nothing to destroy
+  std::free(buckets);
+}
+
+TranspositionTable::TranspositionTable(std::size_t megabytes)
+  : mask{ 0 }, age{ 0 }, probes{ 0 }, hits{ 0 }
+{
+  resize(megabytes);
+}
+
+void TranspositionTable::resize(std::size_t megabytes) {
+  std::size_t wanted = std::max<std::size_t>(1, megabytes * 1024 * 1024 / sizeof(Bucket));
+  std::size_t size = 1;
+  while (size * 2 <= wanted) size *= 2;
+  void *memory;
+  if (posix_memalign(&memory, alignof(Bucket), size * sizeof(Bucket))) throw std::bad_alloc();
+  Bucket *created = static_cast<Bucket *>(memory);
+  for (std::size_t i = 0; i < size; ++i) new (&created[i]) Bucket;
+  buckets.reset(created);
+  mask = size - 1;
+  clear();
+}
+
+void TranspositionTable::clear() {
+  for (uint64_t i = 0; i <= mask; ++i) {
+    for (Slot &slot : buckets[i].slots) {
+      slot.check.store(0, std::memory_order_relaxed);
+      slot.data.store(0, std::memory_order_relaxed);
+    }
+  }
+  age = 0;
+  probes = 0;
+  hits = 0;
+}
+
+void TranspositionTable::newSearch() {
+  age = (age + 1) & 0x3f;
+}
+
+TranspositionTable::Bucket &TranspositionTable::bucketFor(uint64_t key) {
+  return buckets[key & mask];
+}
+
+uint16_t TranspositionTable::encodeMove(const Move *move) {
+  // from == to never happens in a real move, so 0 means no move
+  if (!move) return 0;
+  return (move->from.row * 8 + move->from.col)
+    | (move->to.row * 8 + move->to.col) << 6
+    | move->promoteTo << 12;
+}
+
+std::unique_ptr<Move> TranspositionTable::decodeMove(uint16_t bits) {
+  if (!bits) return nullptr;
+  int from = bits & 0x3f, to = (bits >> 6) & 0x3f;
+  return std::make_unique<Move>(Coord(from / 8, from % 8), Coord(to / 8, to % 8),
+    static_cast<PieceType>(bits >> 12));
+}
+
+bool TranspositionTable::probe(uint64_t key, Entry &entry) {
+  probes.fetch_add(1, std::memory_order_relaxed);
+  for (const Slot &slot : bucketFor(key).slots) {
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    if (!data || (slot.check.load(std::memory_order_relaxed) ^ data) != key) continue;
+    hits.fetch_add(1, std::memory_order_relaxed);
+    entry.bestMove = decodeMove(data & 0xffff);
+    entry.score = static_cast<int32_t>(data >> 16);
+    entry.depth = static_cast<int8_t>(data >> 48);
+    entry.bound = static_cast<Bound>((data >> 56) & 0x3);
+    return true;
+  }
+  return false;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, Bound bound, int score, const Move *bestMove) {
+  Bucket &bucket = bucketFor(key);
+  // replace the same position if present, otherwise the entry that is worth
+  // the least: shallow entries from old searches go first
+  Slot *victim = nullptr;
+  uint64_t victimData = 0;
+  int victimWorth = 0;
+  for (Slot &slot : bucket.slots) {
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    if (data && (slot.check.load(std::memory_order_relaxed) ^ data) == key) {
+      victim = &slot;
+      victimData = data;
+      break;
+    }
+    int slotDepth = static_cast<int8_t>(data >> 48);
+    unsigned slotAge = data >> 58;
+    int worth = data ? slotDepth - 8 * ((age - slotAge) & 0x3f) : -1000;
+    if (!victim || worth < victimWorth) {
+      victim = &slot;
+      victimData = 0;
+      victimWorth = worth;
+    }
+  }
+  uint64_t move = encodeMove(bestMove);
+  if (!move) move = victimData & 0xffff;
+  depth = std::max(-128, std::min(127, depth));
+  uint64_t data = move
+    | static_cast<uint64_t>(static_cast<uint32_t>(score)) << 16
+    | static_cast<uint64_t>(static_cast<uint8_t>(depth)) << 48
+    | static_cast<uint64_t>(bound) << 56
+    | static_cast<uint64_t>(age) << 58;
+  victim->data.store(data, std::memory_order_relaxed);
+  victim->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+std::size_t TranspositionTable::numEntries() const {
+  return (mask + 1) * bucketSize;
+}
+
+uint64_t TranspositionTable::numProbes() const {
+  return probes;
+}
+
+uint64_t TranspositionTable::numHits() const {
+  return hits;
+}
+
+double TranspositionTable::hitRate() const {
+  uint64_t probed = probes;
+  return probed ? static_cast<double>(hits) / probed : 0;
+}
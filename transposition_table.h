@@ -0,0 +1,84 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "move.h"
+
+// fixed-size hash table of search results keyed by Board::getHash()
+// the table is split into buckets of entries sharing a cache line, a position
+// may be stored in any entry of the bucket its hash maps to
+// probe and store may be called from several threads at once without locking:
+// an entry torn by concurrent writes fails verification and reads as a miss
+class TranspositionTable {
+public:
+  enum Bound {
+    NONE,
+    // score is the exact value of the position
+    EXACT,
+    // score is a lower bound (search failed high)
+    LOWER,
+    // score is an upper bound (search failed low)
+    UPPER,
+  };
+  struct Entry {
+    int depth;
+    Bound bound;
+    int score;
+    // null if no best move is known (e.g. all moves failed low)
+    std::unique_ptr<Move> bestMove;
+    Entry();
+  };
+private:
+  // an entry packed into two words so a bucket fits in a cache line
+  // the key is stored xored with the data, so a slot whose words come from
+  // different writes doesn't match any key
+  struct Slot {
+    std::atomic<uint64_t> check;
+    // bits 0-15 move, 16-47 score, 48-55 depth, 56-57 bound, 58-63 age
+    std::atomic<uint64_t> data;
+  };
+  static const int bucketSize = 4;
+  struct alignas(64) Bucket {
+    Slot slots[bucketSize];
+  };
+  // new doesn't honour alignas beyond the default alignment before C++17, so
+  // the buckets are allocated with posix_memalign and released with free
+  struct FreeBuckets {
+    void operator()(Bucket *buckets) const;
+  };
+  std::unique_ptr<Bucket[], FreeBuckets> buckets;
+  // number of buckets - 1, the number of buckets is a power of two
+  uint64_t mask;
+  // incremented every search so entries from old searches get replaced first
+  unsigned age;
+  std::atomic<uint64_t> probes, hits;
+  Bucket &bucketFor(uint64_t key);
+public:
+  // packs a move into 16 bits, a null pointer (or a null move) into 0
+  static uint16_t encodeMove(const Move *move);
+  static std::unique_ptr<Move> decodeMove(uint16_t bits);
+  // size is rounded down to a power of two number of buckets
+  explicit TranspositionTable(std::size_t megabytes = 16);
+  void resize(std::size_t megabytes);
+  // forgets all entries and statistics
+  // NOTE: resize, clear and newSearch must not run during a search
+  void clear();
+  // call at the start of every search
+  void newSearch();
+  // returns whether the position with the given hash was found
+  bool probe(uint64_t key, Entry &entry);
+  // bestMove may be null
+  // keeps the previous best move of the position if bestMove is null
+  void store(uint64_t key, int depth, Bound bound, int score, const Move *bestMove);
+  std::size_t numEntries() const;
+  uint64_t numProbes() const;
+  uint64_t numHits() const;
+  // fraction of probes that found their position, 0 if nothing was probed
+  double hitRate() const;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#include "zobrist.h"
+
+namespace {
+
+struct ZobristKeys {
+  // indexed by [colour][type][row][col]
+  uint64_t pieces[2][6][8][8];
+  // indexed by [colour][kingSide]
+  uint64_t castling[2][2];
+  uint64_t enPassant[8];
+  uint64_t turn;
+  ZobristKeys();
+};
+
+// splitmix64, good enough for hash keys and trivially reproducible
+uint64_t nextKey(uint64_t &state) {
+  uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+ZobristKeys::ZobristKeys() {
+  uint64_t state = 0x4368657373ULL;
+  for (auto &colour : pieces)
+    for (auto &type : colour)
+      for (auto &row : type)
+        for (uint64_t &key : row) key = nextKey(state);
+  for (auto &colour : castling)
+    for (uint64_t &key : colour) key = nextKey(state);
+  for (uint64_t &key : enPassant) key = nextKey(state);
+  turn = nextKey(state);
+}
+
+const ZobristKeys &keys() {
+  static const ZobristKeys keys;
+  return keys;
+}
+
+}
+
+uint64_t zobristPiece(Piece piece, Coord coord) {
+  return keys().pieces[piece.colour][piece.type][coord.row][coord.col];
+}
+
+uint64_t zobristCastling(Colour colour, bool kingSide) {
+  return keys().castling[colour][kingSide];
+}
+
+uint64_t zobristEnPassant(int col) {
+  return keys().enPassant[col];
+}
+
+uint64_t zobristTurn() {
+  return keys().turn;
+}
@@ -0,0 +1,21 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+
+#include "colour.h"
+#include "coord.h"
+#include "piece.h"
+
+// random keys used to hash board positions
+// a position's hash is the xor of the keys of every feature of the position,
+// so it can be updated incrementally as pieces move
+// the keys are generated from a fixed seed, so hashes are stable across runs
+
+uint64_t zobristPiece(Piece piece, Coord coord);
+uint64_t zobristCastling(Colour colour, bool kingSide);
+uint64_t zobristEnPassant(int col);
+// included when black is to move
+uint64_t zobristTurn();
+
+#endif